@@ -0,0 +1,65 @@
+/*
+ * A/B bootloader. Reads the boot state from data EEPROM, lets
+ * slot_select() pick a slot (trial attempts, rollback, fallback to the
+ * other slot when an image fails its CRC), checks only that image with the
+ * CRC unit and jumps to it. Kept minimal so it never needs updating.
+ */
+#include <string.h>
+
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "bootctl.h"
+#include "slot.h"
+
+static int boot_slot_valid(int slot, void *ctx){
+    (void)ctx;
+    return image_valid((const uint8_t *)slot_base(slot), SLOT_SIZE, image_crc_hw);
+}
+
+/* 16 MHz HSI instead of the 2 MHz MSI so the CRC check is quick; the
+   application's SystemInit() switches back to MSI */
+static void boot_clock(void){
+    LL_FLASH_Enable64bitAccess();
+    LL_FLASH_SetLatency(LL_FLASH_LATENCY_1);
+    LL_RCC_HSI_Enable();
+    while(!LL_RCC_HSI_IsReady())
+        ;
+    LL_RCC_SetSysClkSource(LL_RCC_SYS_CLKSOURCE_HSI);
+    while(LL_RCC_GetSysClkSource() != LL_RCC_SYS_CLKSOURCE_STATUS_HSI)
+        ;
+}
+
+static void boot_jump(uint32_t base){
+
+    const uint32_t *vectors = (const uint32_t *)base;
+
+    __disable_irq();
+    SCB->VTOR = base;
+    __set_MSP(vectors[0]);
+    __enable_irq();
+    ((void (*)(void))vectors[1])();
+}
+
+int main(void){
+
+    struct boot_state st, old;
+    int slot;
+
+    boot_clock();
+
+    boot_state_read(&st);
+    old = st;
+    slot = slot_select(&st, boot_slot_valid, NULL);
+    if(memcmp(&st, &old, sizeof(st)) != 0)
+        boot_state_write(&st);
+
+    if(slot >= 0)
+        boot_jump(slot_base(slot));
+
+    /* nothing to boot: wait for a debugger or a reflash */
+    while(1)
+        __WFI();
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <string.h>
+
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "bootctl.h"
+#include "flash.h"
+
+/* One copy of the boot state in data EEPROM; check is written last */
+struct boot_record {
+    struct boot_state st;
+    uint32_t seq;
+    uint32_t check;
+};
+
+#define BOOT_RECORD_WORDS   (sizeof(struct boot_record) / sizeof(uint32_t))
+#define BOOT_RECORD_CHECK   (BOOT_RECORD_WORDS - 1)
+
+static uint32_t boot_record_addr(int i){
+    return BOOT_STATE_ADDR + (uint32_t)i * sizeof(struct boot_record);
+}
+
+static void boot_record_read(int i, struct boot_record *r){
+
+    const __IO uint32_t *src = (const __IO uint32_t *)boot_record_addr(i);
+    uint32_t *dst = (uint32_t *)r;
+    uint32_t n;
+
+    for(n = 0; n < BOOT_RECORD_WORDS; n++)
+        dst[n] = src[n];
+}
+
+static int boot_record_ok(const struct boot_record *r){
+    return r->st.magic == BOOT_STATE_MAGIC &&
+           image_crc_sw((const uint32_t *)r, BOOT_RECORD_CHECK, BOOT_RECORD_WORDS) == r->check;
+}
+
+/* Index of the newest intact copy, -1 if neither is */
+static int boot_record_newest(struct boot_record r[2]){
+
+    int ok0, ok1;
+
+    boot_record_read(0, &r[0]);
+    boot_record_read(1, &r[1]);
+    ok0 = boot_record_ok(&r[0]);
+    ok1 = boot_record_ok(&r[1]);
+    if(ok0 && ok1)
+        return (int32_t)(r[1].seq - r[0].seq) > 0;
+    return ok0 ? 0 : ok1 ? 1 : -1;
+}
+
+void boot_state_read(struct boot_state *st){
+
+    struct boot_record r[2];
+    int i = boot_record_newest(r);
+
+    if(i < 0)
+        memset(st, 0, sizeof(*st));
+    else
+        *st = r[i].st;
+}
+
+int boot_state_write(const struct boot_state *st){
+
+    struct boot_record r[2];
+    int cur = boot_record_newest(r), i = cur == 0;
+    const uint32_t *src;
+    uint32_t n;
+
+    r[i].st = *st;
+    r[i].seq = cur < 0 ? 0 : r[cur].seq + 1;
+    r[i].check = image_crc_sw((const uint32_t *)&r[i], BOOT_RECORD_CHECK, BOOT_RECORD_WORDS);
+
+    /* the check word last: until it is in, this copy reads as torn */
+    src = (const uint32_t *)&r[i];
+    for(n = 0; n < BOOT_RECORD_WORDS; n++)
+        if(eeprom_write_word(boot_record_addr(i) + 4 * n, src[n]) != 0)
+            return -1;
+
+    return 0;
+}
+
+uint32_t image_crc_hw(const uint32_t *words, size_t n, size_t zero_index){
+
+    size_t i;
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_CRC);
+    LL_CRC_ResetCRCCalculationUnit(CRC);
+
+    /* keep the per-word loop free of the zero_index test */
+    for(i = 0; i < n && i < zero_index; i++)
+        LL_CRC_FeedData32(CRC, words[i]);
+    if(i < n){
+        LL_CRC_FeedData32(CRC, 0);
+        for(i++; i < n; i++)
+            LL_CRC_FeedData32(CRC, words[i]);
+    }
+
+    return LL_CRC_ReadData32(CRC);
+}
@@ -0,0 +1,23 @@
+#ifndef BOOTCTL_H
+#define BOOTCTL_H
+
+#include "slot.h"
+
+/* Device side of the A/B scheme, shared by the bootloader and the
+   application: boot state in data EEPROM and image checks with the CRC
+   unit. */
+
+/* The state is kept twice, each copy with a sequence number and a CRC
+   written last. A write goes to the older copy, so a power loss during it
+   leaves the previous state readable: no update of several fields is ever
+   seen half done. */
+
+/* Newest intact copy; st->magic is 0 if there is none */
+void boot_state_read(struct boot_state *st);
+/* Writes only the words that changed. Returns 0 or -1. */
+int boot_state_write(const struct boot_state *st);
+
+/* image_crc_t on the CRC peripheral, same result as image_crc_sw() */
+uint32_t image_crc_hw(const uint32_t *words, size_t n, size_t zero_index);
+
+#endif /* BOOTCTL_H */
@@ -0,0 +1,52 @@
+#include "cobs.h"
+
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst){
+
+    uint8_t *code = dst;        /* where the current block length goes */
+    uint8_t *out = dst + 1;
+    uint8_t n = 1;
+
+    while(len--){
+        uint8_t c = *src++;
+
+        if(c != 0){
+            *out++ = c;
+            n++;
+        }
+        if(c == 0 || n == 0xFF){
+            *code = n;
+            code = out++;
+            n = 1;
+            /* a full block at the very end needs no extra code byte */
+            if(c != 0 && len == 0)
+                return (size_t)(code - dst);
+        }
+    }
+    *code = n;
+
+    return (size_t)(out - dst);
+}
+
+int cobs_decode(uint8_t *buf, size_t len){
+
+    const uint8_t *in = buf, *end = buf + len;
+    uint8_t *out = buf;
+
+    while(in < end){
+        uint8_t code = *in++;
+        uint8_t i;
+
+        if(code == 0 || (size_t)(end - in) < (size_t)(code - 1))
+            return -1;
+        /* out never passes in, so copying forward is safe */
+        for(i = 1; i < code; i++){
+            if(*in == 0)
+                return -1;
+            *out++ = *in++;
+        }
+        if(code != 0xFF && in < end)
+            *out++ = 0;
+    }
+
+    return (int)(out - buf);
+}
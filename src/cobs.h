@@ -0,0 +1,23 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Consistent Overhead Byte Stuffing: removes every 0x00 from a buffer at a
+   cost of at most one byte per 254, so 0x00 can delimit frames. */
+
+/* Worst-case encoded size of n bytes (without the delimiter) */
+#define COBS_MAX_ENCODED(n) ((n) + (n) / 254 + 1)
+
+/* Encode len bytes from src into dst, which must not overlap src and must
+   hold COBS_MAX_ENCODED(len) bytes. No delimiter is appended. Returns the
+   encoded length. */
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst);
+
+/* Decode len bytes (without the delimiter) in place: the output is never
+   longer than the input, so it can overwrite it. Returns the decoded
+   length, or -1 if the input is not valid COBS. */
+int cobs_decode(uint8_t *buf, size_t len);
+
+#endif /* COBS_H */
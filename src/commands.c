@@ -0,0 +1,59 @@
+#include "commands.h"
+#include "link_uart.h"
+#include "stack.h"
+#include "update.h"
+
+static struct link *commands_link;
+
+static void cmd_ping(struct link *link, const struct link_frame *f){
+    link_send(link, LINK_PONG, f->payload, f->len);
+}
+
+static void cmd_get_stats(struct link *link, const struct link_frame *f){
+
+    uint8_t buf[LINK_STATS_WORDS * 4];
+    const uint32_t *w = (const uint32_t *)&link->stats;
+    uint32_t i;
+
+    (void)f;
+    for(i = 0; i < LINK_STATS_WORDS; i++)
+        link_put_u32(&buf[i * 4], w[i]);
+    link_send(link, LINK_STATS, buf, sizeof(buf));
+}
+
+static const struct link_command commands[] = {
+    { LINK_PING,        cmd_ping },
+    { LINK_GET_STATS,   cmd_get_stats },
+    { LINK_UPDATE_BEGIN, update_begin },
+    { LINK_UPDATE_DATA, update_data },
+    { LINK_UPDATE_END,  update_end },
+};
+
+void commands_init(void){
+    commands_link = link_uart_init(commands, sizeof(commands) / sizeof(commands[0]));
+}
+
+void commands_poll(void){
+    link_uart_poll();
+}
+
+void commands_telemetry(uint32_t now){
+
+    static uint32_t last_cycles, last_bytes;
+    const struct link_stats *s = &commands_link->stats;
+    uint32_t cycles = s->rx_cycles - last_cycles;
+    uint32_t bytes = s->rx_bytes - last_bytes;
+    uint32_t cpb = 0;
+
+    /* parse cost over the last period, the counters wrap */
+    if(bytes)
+        cpb = (uint32_t)((uint64_t)cycles * 100 / bytes);
+    last_cycles = s->rx_cycles;
+    last_bytes = s->rx_bytes;
+
+    link_telemetry_add(commands_link, LINK_TM_UPTIME, now);
+    link_telemetry_add(commands_link, LINK_TM_STACK_PEAK, stack_peak_usage());
+    link_telemetry_add(commands_link, LINK_TM_RX_FRAMES, s->rx_frames);
+    link_telemetry_add(commands_link, LINK_TM_RX_CYCLES, cpb);
+    link_telemetry_flush(commands_link);
+}
@@ -0,0 +1,16 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <stdint.h>
+
+/* Device side of the binary link: command table and periodic telemetry */
+
+void commands_init(void);
+
+/* Receive and dispatch pending commands, call as often as possible */
+void commands_poll(void);
+
+/* Send one batch of telemetry records */
+void commands_telemetry(uint32_t now);
+
+#endif /* COMMANDS_H */
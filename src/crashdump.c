@@ -0,0 +1,158 @@
+#include <string.h>
+
+#include "crashdump.h"
+#include "crc32.h"
+
+#define CRASHDUMP_LINES ((CRASHDUMP_WORDS + CRASHDUMP_LINE_WORDS - 1) / CRASHDUMP_LINE_WORDS)
+
+static uint32_t crashdump_crc(const struct crashdump *d){
+    return crc32_update(CRC32_INIT, d, offsetof(struct crashdump, crc));
+}
+
+void crashdump_capture(struct crashdump *d, const uint32_t *frame,
+                       uint32_t exc_return, uint32_t exception,
+                       const struct crashdump_fsr *fsr,
+                       const uint32_t *stack_end){
+
+    const uint32_t *sp;
+    uint32_t i, n;
+
+    d->magic = CRASHDUMP_MAGIC;
+    d->version = CRASHDUMP_VERSION;
+    for(i = 0; i < CD_FRAME_WORDS; i++)
+        d->frame[i] = frame[i];
+    d->exc_return = exc_return;
+    d->exception = exception;
+    d->fsr = *fsr;
+
+    /* xPSR bit 9 tells that the core inserted a padding word to keep the
+       frame 8-byte aligned */
+    sp = frame + CD_FRAME_WORDS + ((frame[CD_XPSR] >> 9) & 1);
+    d->sp = (uint32_t)(uintptr_t)sp;
+
+    n = 0;
+    if(sp < stack_end){
+        n = (uint32_t)(stack_end - sp);
+        if(n > CRASHDUMP_STACK_WORDS)
+            n = CRASHDUMP_STACK_WORDS;
+    }
+    for(i = 0; i < n; i++)
+        d->stack[i] = sp[i];
+    for(; i < CRASHDUMP_STACK_WORDS; i++)
+        d->stack[i] = 0;
+    d->stack_words = n;
+
+    d->crc = crashdump_crc(d);
+}
+
+int crashdump_valid(const struct crashdump *d){
+    return d->magic == CRASHDUMP_MAGIC &&
+           d->version == CRASHDUMP_VERSION &&
+           d->stack_words <= CRASHDUMP_STACK_WORDS &&
+           d->crc == crashdump_crc(d);
+}
+
+void crashdump_clear(struct crashdump *d){
+    d->magic = 0;
+}
+
+static char *put_hex(char *p, uint32_t v, int digits){
+    static const char hex[] = "0123456789abcdef";
+
+    while(digits--)
+        *p++ = hex[(v >> (4 * digits)) & 0xF];
+    return p;
+}
+
+size_t crashdump_encode_line(const struct crashdump *d, unsigned line,
+                             char *buf, size_t size){
+
+    const uint32_t *w = (const uint32_t *)d;
+    unsigned first, i;
+    char *p = buf;
+
+    if(line > CRASHDUMP_LINES)
+        return 0;
+
+    if(line == CRASHDUMP_LINES){
+        if(size < sizeof(CRASHDUMP_TAG " END"))
+            return 0;
+        memcpy(buf, CRASHDUMP_TAG " END", sizeof(CRASHDUMP_TAG " END"));
+        return sizeof(CRASHDUMP_TAG " END") - 1;
+    }
+
+    /* "@CD oo" then up to 8 x " wwwwwwww" */
+    if(size < sizeof(CRASHDUMP_TAG) + 3 + CRASHDUMP_LINE_WORDS * 9)
+        return 0;
+
+    first = line * CRASHDUMP_LINE_WORDS;
+    memcpy(p, CRASHDUMP_TAG " ", sizeof(CRASHDUMP_TAG));
+    p += sizeof(CRASHDUMP_TAG);
+    p = put_hex(p, first, 2);
+    for(i = first; i < first + CRASHDUMP_LINE_WORDS && i < CRASHDUMP_WORDS; i++){
+        *p++ = ' ';
+        p = put_hex(p, w[i], 8);
+    }
+    *p = '\0';
+
+    return (size_t)(p - buf);
+}
+
+/* Parse up to max hex digits; returns digits consumed */
+static int get_hex(const char **s, uint32_t *v, int max){
+    int n = 0;
+
+    *v = 0;
+    while(n < max){
+        char c = **s;
+        uint32_t x;
+
+        if(c >= '0' && c <= '9')
+            x = c - '0';
+        else if(c >= 'a' && c <= 'f')
+            x = c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            x = c - 'A' + 10;
+        else
+            break;
+        *v = (*v << 4) | x;
+        (*s)++;
+        n++;
+    }
+    return n;
+}
+
+enum crashdump_status crashdump_decode_line(struct crashdump *d, const char *line){
+
+    uint32_t *w = (uint32_t *)d;
+    const char *s;
+    uint32_t off;
+
+    /* the tag may follow a log prefix such as a timestamp */
+    s = strstr(line, CRASHDUMP_TAG " ");
+    if(s == NULL)
+        return CRASHDUMP_IGNORED;
+    s += sizeof(CRASHDUMP_TAG);
+
+    if(strncmp(s, "END", 3) == 0)
+        return crashdump_valid(d) ? CRASHDUMP_DONE : CRASHDUMP_ERROR;
+
+    if(get_hex(&s, &off, 2) != 2 || off % CRASHDUMP_LINE_WORDS != 0 ||
+       off >= CRASHDUMP_WORDS)
+        return CRASHDUMP_ERROR;
+
+    /* a fresh record starts at offset 0 */
+    if(off == 0)
+        memset(d, 0, sizeof(*d));
+
+    while(*s == ' '){
+        uint32_t v;
+
+        s++;
+        if(off >= CRASHDUMP_WORDS || get_hex(&s, &v, 8) != 8)
+            return CRASHDUMP_ERROR;
+        w[off++] = v;
+    }
+
+    return CRASHDUMP_PARTIAL;
+}
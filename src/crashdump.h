@@ -0,0 +1,83 @@
+#ifndef CRASHDUMP_H
+#define CRASHDUMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Post-mortem record written by the fault handlers into .noinit RAM and
+   printed on the next boot. This file has no hardware dependencies: the
+   host tool (tools/crashdecode.c) links the same encoder/decoder. */
+
+#define CRASHDUMP_MAGIC         0xC4A5D00Du
+#define CRASHDUMP_VERSION       1u
+#define CRASHDUMP_STACK_WORDS   32u     /* words copied above the exception frame */
+
+/* Marker at the start of every emitted dump line */
+#define CRASHDUMP_TAG           "@CD"
+/* Words per emitted line, keeps a line under 100 characters */
+#define CRASHDUMP_LINE_WORDS    8u
+
+/* Offsets in the hardware-stacked exception frame */
+enum {
+    CD_R0 = 0, CD_R1, CD_R2, CD_R3, CD_R12, CD_LR, CD_PC, CD_XPSR,
+    CD_FRAME_WORDS
+};
+
+/* Fault status registers, read by the caller so this stays portable */
+struct crashdump_fsr {
+    uint32_t cfsr;
+    uint32_t hfsr;
+    uint32_t mmfar;
+    uint32_t bfar;
+};
+
+/* Only uint32_t members: the record is emitted and checksummed as words */
+struct crashdump {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frame[CD_FRAME_WORDS];         /* r0-r3, r12, lr, pc, xpsr */
+    uint32_t exc_return;                    /* lr on handler entry */
+    uint32_t exception;                     /* IPSR, active vector number */
+    uint32_t sp;                            /* sp before the frame was stacked */
+    struct crashdump_fsr fsr;
+    uint32_t stack_words;                   /* valid words in stack[] */
+    uint32_t stack[CRASHDUMP_STACK_WORDS];
+    uint32_t crc;                           /* CRC-32 of all previous words */
+};
+
+#define CRASHDUMP_WORDS (sizeof(struct crashdump) / sizeof(uint32_t))
+
+/* Results of crashdump_decode_line() */
+enum crashdump_status {
+    CRASHDUMP_IGNORED,      /* not a dump line */
+    CRASHDUMP_PARTIAL,      /* line accepted, more expected */
+    CRASHDUMP_DONE,         /* complete record with a valid CRC */
+    CRASHDUMP_ERROR         /* malformed line or bad CRC */
+};
+
+/* Fill d from the exception frame and seal it with a CRC. frame points at
+   the stacked r0, stack_end is the top of the stack region (_estack); at
+   most CRASHDUMP_STACK_WORDS words between the pre-exception sp and
+   stack_end are copied. Must not use much stack: it runs in fault context. */
+void crashdump_capture(struct crashdump *d, const uint32_t *frame,
+                       uint32_t exc_return, uint32_t exception,
+                       const struct crashdump_fsr *fsr,
+                       const uint32_t *stack_end);
+
+/* Non-zero when d holds a sealed record with a matching CRC */
+int crashdump_valid(const struct crashdump *d);
+
+/* Invalidate the record so it is reported only once */
+void crashdump_clear(struct crashdump *d);
+
+/* Format line number `line` of the record into buf (NUL terminated, no
+   newline). Returns the string length, 0 once all lines have been emitted
+   or if buf is too small. The last line is "@CD END". */
+size_t crashdump_encode_line(const struct crashdump *d, unsigned line,
+                             char *buf, size_t size);
+
+/* Feed one text line to the decoder. Lines without the tag are ignored, so
+   a whole log can be piped through it. */
+enum crashdump_status crashdump_decode_line(struct crashdump *d, const char *line);
+
+#endif /* CRASHDUMP_H */
@@ -0,0 +1,15 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Standard CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320), same result as
+   zlib's crc32(). Plain C so the host tools compute identical values. */
+
+#define CRC32_INIT 0x00000000u
+
+/* Continue a CRC over len more bytes; start with crc = CRC32_INIT */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+#endif /* CRC32_H */
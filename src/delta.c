@@ -0,0 +1,320 @@
+#include <string.h>
+
+#include "delta.h"
+
+/* Decoder states: what the bytes collected at dst are */
+enum {
+    ST_HEADER,
+    ST_OP,
+    ST_SAME,
+    ST_COPY,
+    ST_LITERAL,
+    ST_PATCH,
+    ST_RANGE,
+    ST_RANGE_DATA
+};
+
+static uint32_t get_u16(const uint8_t *p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p){
+    return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+static uint8_t *put_u16(uint8_t *p, uint32_t v){
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v){
+    return put_u16(put_u16(p, v), v >> 16);
+}
+
+static uint32_t block_len(uint32_t total, uint32_t block){
+    uint32_t left = total - block * DELTA_BLOCK;
+
+    return left < DELTA_BLOCK ? left : DELTA_BLOCK;
+}
+
+/* Base block, zero filled past the end of the base image */
+static void base_block(const uint8_t *base, uint32_t base_len, uint32_t block, uint8_t *out){
+
+    uint32_t off = block * DELTA_BLOCK;
+    uint32_t n = 0;
+
+    if(off < base_len)
+        n = block_len(base_len, block);
+    memcpy(out, base + off, n);
+    memset(out + n, 0, DELTA_BLOCK - n);
+}
+
+/* ---- decoder ---- */
+
+static void expect(struct delta_decoder *d, int state, uint8_t *dst, uint32_t need){
+    d->state = (uint8_t)state;
+    d->dst = dst;
+    d->need = need;
+    d->fill = 0;
+}
+
+static void next_op(struct delta_decoder *d){
+    if(d->block == d->blocks)
+        d->status = DELTA_DONE;
+    else
+        expect(d, ST_OP, d->args, 1);
+}
+
+static void emit(struct delta_decoder *d){
+    if(d->write(d->ctx, d->block, d->buf, block_len(d->hdr.target_len, d->block)) != 0){
+        d->status = DELTA_ERR_WRITE;
+        return;
+    }
+    d->block++;
+    next_op(d);
+}
+
+static void step(struct delta_decoder *d){
+
+    uint32_t n, off;
+
+    switch(d->state){
+    case ST_HEADER:
+        d->hdr.magic = get_u32(d->args);
+        d->hdr.block_size = get_u32(d->args + 4);
+        d->hdr.base_len = get_u32(d->args + 8);
+        d->hdr.base_crc = get_u32(d->args + 12);
+        d->hdr.target_len = get_u32(d->args + 16);
+        d->hdr.target_crc = get_u32(d->args + 20);
+        if(d->hdr.magic != DELTA_MAGIC || d->hdr.block_size != DELTA_BLOCK){
+            d->status = DELTA_ERR_FORMAT;
+            return;
+        }
+        if(d->hdr.target_len > d->max_len || d->hdr.base_len > d->base_len){
+            d->status = DELTA_ERR_SIZE;
+            return;
+        }
+        d->blocks = (d->hdr.target_len + DELTA_BLOCK - 1) / DELTA_BLOCK;
+        next_op(d);
+        break;
+
+    case ST_OP:
+        switch(d->args[0]){
+        case DELTA_OP_SAME:
+            expect(d, ST_SAME, d->args, 2);
+            break;
+        case DELTA_OP_COPY:
+            expect(d, ST_COPY, d->args, 2);
+            break;
+        case DELTA_OP_LITERAL:
+            expect(d, ST_LITERAL, d->buf, block_len(d->hdr.target_len, d->block));
+            break;
+        case DELTA_OP_PATCH:
+            expect(d, ST_PATCH, d->args, 1);
+            break;
+        default:
+            d->status = DELTA_ERR_FORMAT;
+        }
+        break;
+
+    case ST_SAME:
+        n = get_u16(d->args);
+        if(n == 0 || n > d->blocks - d->block){
+            d->status = DELTA_ERR_FORMAT;
+            return;
+        }
+        while(n-- && d->status == DELTA_MORE){
+            base_block(d->base, d->hdr.base_len, d->block, d->buf);
+            emit(d);
+        }
+        break;
+
+    case ST_COPY:
+        n = get_u16(d->args);
+        if(n * DELTA_BLOCK >= d->hdr.base_len){
+            d->status = DELTA_ERR_FORMAT;
+            return;
+        }
+        base_block(d->base, d->hdr.base_len, n, d->buf);
+        emit(d);
+        break;
+
+    case ST_LITERAL:
+        emit(d);
+        break;
+
+    case ST_PATCH:
+        base_block(d->base, d->hdr.base_len, d->block, d->buf);
+        d->ranges = d->args[0];
+        if(d->ranges == 0)
+            emit(d);
+        else
+            expect(d, ST_RANGE, d->args, 2);
+        break;
+
+    case ST_RANGE:
+        off = d->args[0];
+        n = d->args[1];
+        if(n == 0 || off + n > block_len(d->hdr.target_len, d->block)){
+            d->status = DELTA_ERR_FORMAT;
+            return;
+        }
+        expect(d, ST_RANGE_DATA, d->buf + off, n);
+        break;
+
+    case ST_RANGE_DATA:
+        if(--d->ranges == 0)
+            emit(d);
+        else
+            expect(d, ST_RANGE, d->args, 2);
+        break;
+    }
+}
+
+void delta_decoder_init(struct delta_decoder *d, const uint8_t *base, uint32_t base_len,
+                        uint32_t max_len, delta_write_t write, void *ctx){
+    memset(d, 0, sizeof(*d));
+    d->base = base;
+    d->base_len = base_len;
+    d->max_len = max_len;
+    d->write = write;
+    d->ctx = ctx;
+    d->status = DELTA_MORE;
+    expect(d, ST_HEADER, d->args, DELTA_HEADER);
+}
+
+int delta_decode(struct delta_decoder *d, const uint8_t *data, size_t len){
+    while(len > 0 && d->status == DELTA_MORE){
+        size_t n = d->need - d->fill;
+
+        if(n > len)
+            n = len;
+        memcpy(d->dst + d->fill, data, n);
+        d->fill += n;
+        data += n;
+        len -= n;
+        if(d->fill == d->need)
+            step(d);
+    }
+
+    return d->status;
+}
+
+/* ---- encoder ---- */
+
+/* Bytes of a PATCH op turning base into target, or 0 if it would not be
+   smaller than a literal; ranges are written to out if not NULL */
+static size_t patch_encode(const uint8_t *base, const uint8_t *target, uint32_t len,
+                           uint8_t *out){
+
+    size_t size = 2;
+    uint32_t i = 0, ranges = 0;
+
+    while(i < len){
+        uint32_t start, end, gap;
+
+        if(base[i] == target[i]){
+            i++;
+            continue;
+        }
+        /* extend the range over short equal runs: a new range costs 2 */
+        start = end = i;
+        while(end < len && end - start < 255){
+            if(base[end] != target[end]){
+                end++;
+                continue;
+            }
+            for(gap = end; gap < len && gap - end < 3 && base[gap] == target[gap]; gap++)
+                ;
+            if(gap == len || gap - end >= 3 || gap - start > 255)
+                break;
+            end = gap;
+        }
+        if(++ranges > 255)
+            return 0;
+        size += 2 + (end - start);
+        if(size >= 1 + len)
+            return 0;
+        if(out != NULL){
+            uint8_t *p = out + size - (2 + (end - start));
+
+            p[0] = (uint8_t)start;
+            p[1] = (uint8_t)(end - start);
+            memcpy(p + 2, target + start, end - start);
+        }
+        i = end;
+    }
+
+    if(out != NULL){
+        out[0] = DELTA_OP_PATCH;
+        out[1] = (uint8_t)ranges;
+    }
+    return size;
+}
+
+size_t delta_encode(const uint8_t *base, uint32_t base_len, uint32_t base_crc,
+                    const uint8_t *target, uint32_t target_len, uint32_t target_crc,
+                    uint8_t *out, size_t out_size){
+
+    uint32_t blocks = (target_len + DELTA_BLOCK - 1) / DELTA_BLOCK;
+    uint32_t base_blocks = base_len / DELTA_BLOCK;  /* whole blocks only */
+    uint8_t ref[DELTA_BLOCK];
+    uint8_t *p = out, *same = NULL;
+    uint32_t b, k, run = 0;
+
+    if(out_size < DELTA_MAX_SIZE(target_len))
+        return 0;
+
+    p = put_u32(p, DELTA_MAGIC);
+    p = put_u32(p, DELTA_BLOCK);
+    p = put_u32(p, base_len);
+    p = put_u32(p, base_crc);
+    p = put_u32(p, target_len);
+    p = put_u32(p, target_crc);
+
+    for(b = 0; b < blocks; b++){
+        const uint8_t *t = target + b * DELTA_BLOCK;
+        uint32_t len = block_len(target_len, b);
+        size_t n;
+
+        base_block(base, base_len, b, ref);
+        if(memcmp(ref, t, len) == 0){
+            /* extend the current SAME run */
+            if(same == NULL || run == 0xFFFF){
+                same = p;
+                run = 0;
+                *p = DELTA_OP_SAME;
+                p += 3;
+            }
+            put_u16(same + 1, ++run);
+            continue;
+        }
+        same = NULL;
+
+        /* moved block: full base blocks only */
+        if(len == DELTA_BLOCK){
+            for(k = 0; k < base_blocks; k++)
+                if(memcmp(base + k * DELTA_BLOCK, t, DELTA_BLOCK) == 0)
+                    break;
+            if(k < base_blocks){
+                *p = DELTA_OP_COPY;
+                p = put_u16(p + 1, k);
+                continue;
+            }
+        }
+
+        n = patch_encode(ref, t, len, NULL);
+        if(n != 0){
+            patch_encode(ref, t, len, p);
+            p += n;
+            continue;
+        }
+
+        *p++ = DELTA_OP_LITERAL;
+        memcpy(p, t, len);
+        p += len;
+    }
+
+    return (size_t)(p - out);
+}
@@ -0,0 +1,96 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Block-based delta between two firmware images. The target is rebuilt
+   one DELTA_BLOCK (one flash page) at a time from the base image, so
+   unchanged pages cost a few bytes to transfer, and the device can skip
+   erasing and programming pages whose content does not change.
+
+   Stream: header, then one op per target block (SAME covers a run):
+       SAME    count(u16)        blocks equal to the base at the same index
+       COPY    block(u16)        block equal to another base block
+       LITERAL data[len]         raw block
+       PATCH   n(u8) n x { offset(u8) len(u8) data[len] }
+                                 base block at the same index, with ranges
+                                 replaced
+   Integers are little endian. Base bytes past base_len read as 0, the
+   erased value of the STM32L1 flash.
+
+   The decoder is incremental so data can be fed as it arrives from the
+   link. No hardware dependencies: tools/imgtool.c uses the same code. */
+
+#define DELTA_MAGIC     0x31544C44u     /* "DLT1" */
+#define DELTA_BLOCK     256u
+#define DELTA_HEADER    24u
+
+enum delta_op {
+    DELTA_OP_SAME = 1,
+    DELTA_OP_COPY,
+    DELTA_OP_LITERAL,
+    DELTA_OP_PATCH
+};
+
+struct delta_header {
+    uint32_t magic;
+    uint32_t block_size;
+    uint32_t base_len;
+    uint32_t base_crc;      /* image CRC of the base, see slot.h */
+    uint32_t target_len;
+    uint32_t target_crc;
+};
+
+/* Decoder status */
+#define DELTA_MORE          0   /* waiting for more input */
+#define DELTA_DONE          1   /* all target blocks written */
+#define DELTA_ERR_FORMAT    (-1)
+#define DELTA_ERR_SIZE      (-2)
+#define DELTA_ERR_WRITE     (-3)
+
+/* Store target block `block` (len < DELTA_BLOCK only for the last one).
+   Returns 0 on success. */
+typedef int (*delta_write_t)(void *ctx, uint32_t block, const uint8_t *data, size_t len);
+
+struct delta_decoder {
+    const uint8_t *base;
+    uint32_t base_len;
+    uint32_t max_len;           /* largest target accepted */
+    delta_write_t write;
+    void *ctx;
+
+    struct delta_header hdr;
+    uint32_t block;             /* next target block */
+    uint32_t blocks;
+    int status;
+
+    /* current item: need bytes are collected at dst */
+    uint8_t *dst;
+    uint32_t need;
+    uint32_t fill;
+    uint8_t state;
+    uint8_t ranges;             /* PATCH ranges left */
+    uint8_t args[DELTA_HEADER];
+    uint8_t buf[DELTA_BLOCK];   /* block being assembled */
+};
+
+void delta_decoder_init(struct delta_decoder *d, const uint8_t *base, uint32_t base_len,
+                        uint32_t max_len, delta_write_t write, void *ctx);
+
+/* Feed len more bytes. Returns DELTA_MORE, DELTA_DONE or a DELTA_ERR_*
+   code; once done or failed, further input is ignored. The header is in
+   d->hdr as soon as its bytes are in, for the caller to check base_crc. */
+int delta_decode(struct delta_decoder *d, const uint8_t *data, size_t len);
+
+/* Worst-case delta size for a target of target_len bytes */
+#define DELTA_MAX_SIZE(target_len) \
+    (DELTA_HEADER + (((target_len) + DELTA_BLOCK - 1) / DELTA_BLOCK) * (1 + DELTA_BLOCK))
+
+/* Encode the delta from base to target into out. Returns its size, or 0
+   if out_size is too small. */
+size_t delta_encode(const uint8_t *base, uint32_t base_len, uint32_t base_crc,
+                    const uint8_t *target, uint32_t target_len, uint32_t target_crc,
+                    uint8_t *out, size_t out_size);
+
+#endif /* DELTA_H */
@@ -0,0 +1,75 @@
+#include "stm32l1xx.h"
+
+#include "fault.h"
+#include "log.h"
+
+/* Top of the stack, from the linker script */
+extern uint32_t _estack;
+
+/* Not cleared by the startup code, so it survives NVIC_SystemReset() */
+struct crashdump fault_dump __attribute__((section(".noinit")));
+
+void fault_capture(const uint32_t *frame, uint32_t exc_return, uint32_t ipsr)
+    __attribute__((used, noreturn));
+
+/* Common entry for all the fault vectors: pass the frame from whichever
+   stack was active (EXC_RETURN bit 2), the EXC_RETURN value and the vector
+   number to fault_capture(). Naked so nothing is pushed before we look. */
+__attribute__((naked)) void HardFault_Handler(void){
+    __asm volatile(
+        "tst    lr, #4          \n"
+        "ite    eq              \n"
+        "mrseq  r0, msp         \n"
+        "mrsne  r0, psp         \n"
+        "mov    r1, lr          \n"
+        "mrs    r2, ipsr        \n"
+        "b      fault_capture   \n"
+    );
+}
+
+void MemManage_Handler(void) __attribute__((alias("HardFault_Handler")));
+void BusFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+void UsageFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+
+void fault_capture(const uint32_t *frame, uint32_t exc_return, uint32_t ipsr){
+
+    struct crashdump_fsr fsr;
+
+    fsr.cfsr = SCB->CFSR;
+    fsr.hfsr = SCB->HFSR;
+    fsr.mmfar = SCB->MMFAR;
+    fsr.bfar = SCB->BFAR;
+
+    crashdump_capture(&fault_dump, frame, exc_return, ipsr, &fsr, &_estack);
+
+    /* Recover at once rather than hang; the dump is printed next boot */
+    NVIC_SystemReset();
+}
+
+void fault_init(void){
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk |
+                  SCB_SHCSR_USGFAULTENA_Msk;
+    SCB->CCR |= SCB_CCR_DIV_0_TRP_Msk;
+}
+
+void fault_report(void){
+
+    char line[sizeof(CRASHDUMP_TAG) + 3 + CRASHDUMP_LINE_WORDS * 9];
+    unsigned i;
+
+    if(!crashdump_valid(&fault_dump))
+        return;
+
+    log_puts("fault: crash dump from previous boot, pc=");
+    log_hex(fault_dump.frame[CD_PC]);
+    log_puts(" cfsr=");
+    log_hex(fault_dump.fsr.cfsr);
+    log_puts("\r\n");
+
+    for(i = 0; crashdump_encode_line(&fault_dump, i, line, sizeof(line)); i++){
+        log_puts(line);
+        log_puts("\r\n");
+    }
+
+    crashdump_clear(&fault_dump);
+}
@@ -0,0 +1,17 @@
+#ifndef FAULT_H
+#define FAULT_H
+
+#include "crashdump.h"
+
+/* Record left by the last fault, kept across reset in .noinit RAM */
+extern struct crashdump fault_dump;
+
+/* Enable the MemManage, BusFault and UsageFault exceptions (otherwise
+   they all escalate to HardFault) and trap divide by zero */
+void fault_init(void);
+
+/* Print the dump left by a fault on the previous boot, if any, on the log
+   channel and invalidate it. Call once log_init() has run. */
+void fault_report(void);
+
+#endif /* FAULT_H */
@@ -0,0 +1,126 @@
+#include <string.h>
+
+#include "stm32l1xx.h"
+
+#include "flash.h"
+
+/* PECR unlock keys (RM0038) */
+#define PEKEY1      0x89ABCDEFu
+#define PEKEY2      0x02030405u
+#define PRGKEY1     0x8C9DAEBFu
+#define PRGKEY2     0x13141516u
+
+#define FLASH_ERRORS (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_SIZERR)
+
+static void flash_unlock_data(void){
+    if(FLASH->PECR & FLASH_PECR_PELOCK){
+        FLASH->PEKEYR = PEKEY1;
+        FLASH->PEKEYR = PEKEY2;
+    }
+}
+
+static void flash_unlock_program(void){
+    flash_unlock_data();
+    if(FLASH->PECR & FLASH_PECR_PRGLOCK){
+        FLASH->PRGKEYR = PRGKEY1;
+        FLASH->PRGKEYR = PRGKEY2;
+    }
+}
+
+static void flash_lock(void){
+    FLASH->PECR |= FLASH_PECR_PELOCK;
+}
+
+static int flash_wait(void){
+
+    uint32_t sr;
+
+    while(FLASH->SR & FLASH_SR_BSY)
+        ;
+    sr = FLASH->SR;
+    FLASH->SR = sr & (FLASH_ERRORS | FLASH_SR_EOP);
+
+    return (sr & FLASH_ERRORS) ? -1 : 0;
+}
+
+static int flash_erase_page(uint32_t addr){
+
+    int ret;
+
+    FLASH->PECR |= FLASH_PECR_ERASE | FLASH_PECR_PROG;
+    *(__IO uint32_t *)addr = 0;
+    ret = flash_wait();
+    FLASH->PECR &= ~(FLASH_PECR_ERASE | FLASH_PECR_PROG);
+
+    return ret;
+}
+
+/* Half-page programming may not run from flash: this goes to .RAMtext,
+   which the startup code copies with .data. It must not call anything in
+   flash, and no interrupt handler may run while the bank is busy. */
+__attribute__((section(".RAMtext"), noinline, long_call))
+static int flash_program_half_page(uint32_t addr, const uint32_t *words){
+
+    __IO uint32_t *dst = (__IO uint32_t *)addr;
+    uint32_t i, sr;
+
+    FLASH->PECR |= FLASH_PECR_FPRG | FLASH_PECR_PROG;
+    for(i = 0; i < FLASH_HALF_PAGE / 4; i++)
+        dst[i] = words[i];
+    while(FLASH->SR & FLASH_SR_BSY)
+        ;
+    FLASH->PECR &= ~(FLASH_PECR_FPRG | FLASH_PECR_PROG);
+
+    sr = FLASH->SR;
+    FLASH->SR = sr & (FLASH_ERRORS | FLASH_SR_EOP);
+
+    return (sr & FLASH_ERRORS) ? -1 : 0;
+}
+
+int flash_write_page(uint32_t addr, const uint8_t *data, size_t len){
+
+    uint32_t words[FLASH_PAGE_SIZE / 4];
+    uint32_t primask;
+    int ret;
+
+    if(len > FLASH_PAGE_SIZE || addr % FLASH_PAGE_SIZE != 0)
+        return -1;
+
+    memcpy(words, data, len);
+    memset((uint8_t *)words + len, 0, FLASH_PAGE_SIZE - len);
+    if(memcmp((const void *)addr, words, FLASH_PAGE_SIZE) == 0)
+        return 0;
+
+    flash_unlock_program();
+    ret = flash_erase_page(addr);
+    if(ret == 0){
+        primask = __get_PRIMASK();
+        __disable_irq();
+        ret = flash_program_half_page(addr, words);
+        if(ret == 0)
+            ret = flash_program_half_page(addr + FLASH_HALF_PAGE,
+                                          words + FLASH_HALF_PAGE / 4);
+        __set_PRIMASK(primask);
+    }
+    flash_lock();
+
+    if(ret == 0 && memcmp((const void *)addr, words, FLASH_PAGE_SIZE) != 0)
+        ret = -1;
+
+    return ret;
+}
+
+int eeprom_write_word(uint32_t addr, uint32_t value){
+
+    int ret;
+
+    if(*(const __IO uint32_t *)addr == value)
+        return 0;
+
+    flash_unlock_data();
+    *(__IO uint32_t *)addr = value;
+    ret = flash_wait();
+    flash_lock();
+
+    return ret;
+}
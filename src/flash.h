@@ -0,0 +1,21 @@
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Program memory and data EEPROM writes (STM32L1 PECR interface) */
+
+#define FLASH_PAGE_SIZE     256u    /* erase unit */
+#define FLASH_HALF_PAGE     128u    /* program unit */
+
+/* Write len (<= FLASH_PAGE_SIZE) bytes at the page-aligned addr, padding
+   with 0, the erased value. A page that already holds this content is
+   left alone, so rewriting an unchanged image costs no erase cycles.
+   Returns 0, or -1 on a flash error or failed verify. */
+int flash_write_page(uint32_t addr, const uint8_t *data, size_t len);
+
+/* Write one word of data EEPROM if it differs. Returns 0 or -1. */
+int eeprom_write_word(uint32_t addr, uint32_t value);
+
+#endif /* FLASH_H */
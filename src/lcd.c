@@ -0,0 +1,138 @@
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "lcd.h"
+
+/* LCD_FCR fields (RM0038) */
+#define FCR_PON_SHIFT   4
+#define FCR_CC_SHIFT    10
+#define FCR_DIV_SHIFT   18
+#define FCR_PS_SHIFT    22
+
+/* LSE start-up, ms; without a crystal we fall back to the LSI */
+#define LCD_LSE_TIMEOUT 1000
+
+/* What the controller RAM holds; all off after reset */
+static struct lcd_frame lcd_shown;
+static struct lcd_frame lcd_next;
+
+static void lcd_gpio_init(void){
+
+    LL_GPIO_InitTypeDef GPIO_InitStruct;
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOA | LL_AHB1_GRP1_PERIPH_GPIOB |
+                             LL_AHB1_GRP1_PERIPH_GPIOC);
+
+    /* COM0-2 = PA8-PA10, SEG17 = PA15 */
+    LL_GPIO_StructInit(&GPIO_InitStruct);
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.Alternate = LL_GPIO_AF_11;
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_8 | LL_GPIO_PIN_9 | LL_GPIO_PIN_10 | LL_GPIO_PIN_15;
+    LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    /* SEG7-9 = PB3-PB5, SEG16 = PB8, COM3 = PB9, SEG10-15 = PB10-PB15 */
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_3 | LL_GPIO_PIN_4 | LL_GPIO_PIN_5 | LL_GPIO_PIN_8 |
+                          LL_GPIO_PIN_9 | LL_GPIO_PIN_10 | LL_GPIO_PIN_11 | LL_GPIO_PIN_12 |
+                          LL_GPIO_PIN_13 | LL_GPIO_PIN_14 | LL_GPIO_PIN_15;
+    LL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    /* SEG18-21 = PC0-PC3, SEG24 = PC6 */
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_0 | LL_GPIO_PIN_1 | LL_GPIO_PIN_2 | LL_GPIO_PIN_3 |
+                          LL_GPIO_PIN_6;
+    LL_GPIO_Init(GPIOC, &GPIO_InitStruct);
+}
+
+/* The LCD runs from the RTC clock. Returns its frequency, 0 if unusable. */
+static uint32_t lcd_clock_init(void){
+
+    uint32_t ms;
+
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR);
+    LL_PWR_EnableBkUpAccess();
+
+    /* the RTC clock can only be chosen once per backup domain reset */
+    if(LL_RCC_GetRTCClockSource() == LL_RCC_RTC_CLKSOURCE_NONE){
+        LL_RCC_LSE_Enable();
+        for(ms = 0; ms < LCD_LSE_TIMEOUT && !LL_RCC_LSE_IsReady(); ms++)
+            LL_mDelay(1);
+        if(LL_RCC_LSE_IsReady()){
+            LL_RCC_SetRTCClockSource(LL_RCC_RTC_CLKSOURCE_LSE);
+        } else {
+            LL_RCC_LSE_Disable();
+            LL_RCC_LSI_Enable();
+            while(!LL_RCC_LSI_IsReady())
+                ;
+            LL_RCC_SetRTCClockSource(LL_RCC_RTC_CLKSOURCE_LSI);
+        }
+    }
+
+    switch(LL_RCC_GetRTCClockSource()){
+    case LL_RCC_RTC_CLKSOURCE_LSE:
+        return LSE_VALUE;
+    case LL_RCC_RTC_CLKSOURCE_LSI:
+        return LSI_VALUE;
+    default:
+        return 0;
+    }
+}
+
+int lcd_init(void){
+
+    struct lcd_timing t;
+    uint32_t lcdclk = lcd_clock_init();
+
+    if(lcdclk == 0 ||
+       lcd_timing_select(lcdclk, LCD_COMS, LCD_MIN_FRAME_HZ, LCD_PULSE_US, &t) < 0)
+        return -1;
+
+    lcd_gpio_init();
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_LCD);
+
+    /* FCR while the controller is off, then wait for it to reach the LCD
+       clock domain. No high drive: the pulse-on phases do the charging. */
+    LCD->FCR = ((uint32_t)t.ps << FCR_PS_SHIFT) | ((uint32_t)t.div << FCR_DIV_SHIFT) |
+               ((uint32_t)LCD_CONTRAST << FCR_CC_SHIFT) | ((uint32_t)t.pon << FCR_PON_SHIFT);
+    while(!(LCD->SR & LCD_SR_FCRSR))
+        ;
+
+    /* 1/4 duty, 1/3 bias, internal VLCD */
+    LCD->CR = LCD_CR_DUTY_1 | LCD_CR_DUTY_0 | LCD_CR_BIAS_1 | LCD_CR_LCDEN;
+    while((LCD->SR & (LCD_SR_ENS | LCD_SR_RDY)) != (LCD_SR_ENS | LCD_SR_RDY))
+        ;
+
+    return 0;
+}
+
+int lcd_show(const struct lcd_frame *f){
+
+    uint32_t changed;
+    int i, n = 0;
+
+    if(LCD->SR & LCD_SR_UDR)
+        return LCD_BUSY;
+
+    changed = lcd_frame_diff(&lcd_shown, f);
+    if(changed == 0)
+        return 0;
+
+    for(i = 0; changed != 0; i++, changed >>= 1){
+        if(changed & 1){
+            LCD->RAM[i] = f->ram[i];
+            lcd_shown.ram[i] = f->ram[i];
+            n++;
+        }
+    }
+
+    /* UDR is set-only and the other SR bits are read-only: a plain write,
+       no read-modify-write */
+    LCD->CLR = LCD_CLR_UDDC;
+    LCD->SR = LCD_SR_UDR;
+
+    return n;
+}
+
+int lcd_print(const char *text){
+    lcd_render(&lcd_next, &lcd_layout, text);
+    return lcd_show(&lcd_next);
+}
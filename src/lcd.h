@@ -0,0 +1,41 @@
+#ifndef LCD_H
+#define LCD_H
+
+#include "lcd_frame.h"
+
+/* Segment LCD on the on-chip controller: 4 digit, 14 segment glass with
+   DP and colon, 1/4 duty, 1/3 bias, internal step-up converter, clocked
+   from the RTC clock (LSE, or LSI without a crystal).
+
+   COM0-2 are fixed on PA8-PA10, which is why the binary link uses USART1
+   on PB6/PB7. The SEG lines are in lcd_panel.c. */
+
+/* Panel limits: below LCD_MIN_FRAME_HZ the glass flickers, and each
+   pulse-on phase has to last LCD_PULSE_US for the segments to reach the
+   LCD_CONTRAST voltage (VLCD level 0-7) */
+#define LCD_MIN_FRAME_HZ    30
+#define LCD_PULSE_US        100
+#define LCD_CONTRAST        4
+
+/* lcd_show() status: the previous update has not been latched yet */
+#define LCD_BUSY            (-1)
+
+/* The glass on this board, lcd_panel.c */
+extern const struct lcd_layout lcd_layout;
+
+/* Start the controller at the lowest frame rate the panel allows.
+   Returns 0, or -1 if there is no usable LCD clock. */
+int lcd_init(void);
+
+/* Write the RAM words of f that differ from what is shown and request the
+   update. The controller copies its RAM to the display at the start of the
+   next frame, all words at once, so a frame is never shown half written.
+   Returns the number of words written, or LCD_BUSY without writing
+   anything if the previous request is still pending: the RAM is write
+   protected until then. */
+int lcd_show(const struct lcd_frame *f);
+
+/* Render text with lcd_layout and show it; same return as lcd_show() */
+int lcd_print(const char *text);
+
+#endif /* LCD_H */
@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "lcd_frame.h"
+
+#define A   LCD_SEG_A
+#define B   LCD_SEG_B
+#define C   LCD_SEG_C
+#define D   LCD_SEG_D
+#define E   LCD_SEG_E
+#define F   LCD_SEG_F
+#define G1  LCD_SEG_G1
+#define G2  LCD_SEG_G2
+#define H   LCD_SEG_H
+#define J   LCD_SEG_J
+#define K   LCD_SEG_K
+#define L   LCD_SEG_L
+#define M   LCD_SEG_M
+#define N   LCD_SEG_N
+
+#define FONT_FIRST  ' '
+#define FONT_LAST   '_'
+
+/* ' ' to '_'; const, so it stays in flash */
+static const uint16_t lcd_font[FONT_LAST - FONT_FIRST + 1] = {
+    0,                          /* ' ' */
+    B | C,                      /* ! */
+    F | J,                      /* " */
+    B | C | D | G1 | G2 | J | M,/* # */
+    A | C | D | F | G1 | G2 | J | M, /* $ */
+    C | F | G1 | G2 | K | L,    /* % */
+    A | D | E | G1 | H | J | N, /* & */
+    J,                          /* ' */
+    K | N,                      /* ( */
+    H | L,                      /* ) */
+    G1 | G2 | H | J | K | L | M | N, /* * */
+    G1 | G2 | J | M,            /* + */
+    L,                          /* , */
+    G1 | G2,                    /* - */
+    0,                          /* . (DP of the previous digit) */
+    K | L,                      /* / */
+    A | B | C | D | E | F | K | L, /* 0 */
+    B | C | K,                  /* 1 */
+    A | B | D | E | G1 | G2,    /* 2 */
+    A | B | C | D | G2,         /* 3 */
+    B | C | F | G1 | G2,        /* 4 */
+    A | C | D | F | G1 | G2,    /* 5 */
+    A | C | D | E | F | G1 | G2,/* 6 */
+    A | B | C,                  /* 7 */
+    A | B | C | D | E | F | G1 | G2, /* 8 */
+    A | B | C | D | F | G1 | G2,/* 9 */
+    0,                          /* : (colon of the previous digit) */
+    J | L,                      /* ; */
+    K | N,                      /* < */
+    D | G1 | G2,                /* = */
+    H | L,                      /* > */
+    A | B | G2 | M,             /* ? */
+    A | B | D | E | F | G2 | J, /* @ */
+    A | B | C | E | F | G1 | G2,/* A */
+    A | B | C | D | G2 | J | M, /* B */
+    A | D | E | F,              /* C */
+    A | B | C | D | J | M,      /* D */
+    A | D | E | F | G1,         /* E */
+    A | E | F | G1,             /* F */
+    A | C | D | E | F | G2,     /* G */
+    B | C | E | F | G1 | G2,    /* H */
+    A | D | J | M,              /* I */
+    B | C | D | E,              /* J */
+    E | F | G1 | K | N,         /* K */
+    D | E | F,                  /* L */
+    B | C | E | F | H | K,      /* M */
+    B | C | E | F | H | N,      /* N */
+    A | B | C | D | E | F,      /* O */
+    A | B | E | F | G1 | G2,    /* P */
+    A | B | C | D | E | F | N,  /* Q */
+    A | B | E | F | G1 | G2 | N,/* R */
+    A | C | D | F | G1 | G2,    /* S */
+    A | J | M,                  /* T */
+    B | C | D | E | F,          /* U */
+    E | F | K | L,              /* V */
+    B | C | E | F | L | N,      /* W */
+    H | K | L | N,              /* X */
+    H | K | M,                  /* Y */
+    A | D | K | L,              /* Z */
+    A | D | E | F,              /* [ */
+    H | N,                      /* \ */
+    A | B | C | D,              /* ] */
+    L | N,                      /* ^ */
+    D,                          /* _ */
+};
+
+uint16_t lcd_glyph(char c){
+    if(c >= 'a' && c <= 'z')
+        c = (char)(c - 'a' + 'A');
+    if(c < FONT_FIRST || c > FONT_LAST)
+        return 0;
+    return lcd_font[c - FONT_FIRST];
+}
+
+static void render_digit(struct lcd_frame *f, const struct lcd_layout *layout,
+                         int digit, uint32_t glyph){
+
+    const uint8_t *seg = layout->seg[digit];
+    int b;
+
+    for(b = 0; glyph != 0; b++, glyph >>= 1){
+        const struct lcd_pos *p = &layout->wiring[b];
+        uint32_t s = seg[p->line];
+
+        if(glyph & 1)
+            f->ram[2 * p->com + (s >> 5)] |= 1u << (s & 31);
+    }
+}
+
+void lcd_render(struct lcd_frame *f, const struct lcd_layout *layout, const char *text){
+
+    uint32_t glyph = 0;
+    int digit = -1;
+
+    memset(f, 0, sizeof(*f));
+
+    /* a digit is drawn once its DP and colon are known */
+    for(; *text != '\0'; text++){
+        uint32_t mark = *text == '.' ? LCD_SEG_DP : *text == ':' ? LCD_SEG_COLON : 0;
+
+        if(mark && digit >= 0 && !(glyph & mark)){
+            glyph |= mark;
+            continue;
+        }
+        if(digit >= 0)
+            render_digit(f, layout, digit, glyph);
+        if(++digit == layout->digits)
+            return;
+        glyph = mark ? mark : lcd_glyph(*text);
+    }
+    if(digit >= 0)
+        render_digit(f, layout, digit, glyph);
+}
+
+uint32_t lcd_frame_diff(const struct lcd_frame *shown, const struct lcd_frame *next){
+
+    uint32_t changed = 0;
+    int i;
+
+    for(i = 0; i < LCD_RAM_WORDS; i++)
+        if(shown->ram[i] != next->ram[i])
+            changed |= 1u << i;
+
+    return changed;
+}
+
+int lcd_timing_select(uint32_t lcdclk_hz, uint32_t coms, uint32_t min_frame_hz,
+                      uint32_t pulse_us, struct lcd_timing *t){
+
+    uint32_t best = UINT32_MAX, frame, ck_ps, pon, ps, div;
+
+    for(ps = 0; ps < 16; ps++){
+        for(div = 0; div < 16; div++){
+            /* mHz, duty is 1/coms; LCDCLK is at most 1 MHz */
+            frame = lcdclk_hz * 1000 / ((1u << ps) * (16 + div) * coms);
+            if(frame < min_frame_hz * 1000 || frame >= best)
+                continue;
+            best = frame;
+            t->ps = (uint8_t)ps;
+            t->div = (uint8_t)div;
+            t->frame_mhz = frame;
+        }
+    }
+    if(best == UINT32_MAX)
+        return -1;
+
+    /* pon ck_ps periods of at least pulse_us */
+    ck_ps = lcdclk_hz >> t->ps;
+    pon = (pulse_us * ck_ps + 999999) / 1000000;
+    t->pon = (uint8_t)(pon > 7 ? 7 : pon);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef LCD_FRAME_H
+#define LCD_FRAME_H
+
+#include <stdint.h>
+
+/* Frame buffer for the STM32L1 segment LCD: glyph rendering, the compare
+   that finds which LCD->RAM words changed, and the frame rate selection.
+   No hardware dependencies, so it also runs on the host (tools/lcdbench.c);
+   src/lcd.c moves the frames to the controller. */
+
+#define LCD_COMS        4
+#define LCD_RAM_WORDS   16      /* LCD->RAM[]: COMn is word 2n (SEG0-31) and 2n+1 (SEG32-43) */
+
+struct lcd_frame {
+    uint32_t ram[LCD_RAM_WORDS];
+};
+
+/* 14-segment glyph bits:
+
+        ---A---
+       |\  |  /|
+       F H J K B
+       |  \|/  |
+        -G1-G2-
+       |  /|\  |
+       E L M N C
+       |/  |  \|
+        ---D---   DP  COLON
+*/
+#define LCD_SEG_A       (1u << 0)
+#define LCD_SEG_B       (1u << 1)
+#define LCD_SEG_C       (1u << 2)
+#define LCD_SEG_D       (1u << 3)
+#define LCD_SEG_E       (1u << 4)
+#define LCD_SEG_F       (1u << 5)
+#define LCD_SEG_G1      (1u << 6)
+#define LCD_SEG_G2      (1u << 7)
+#define LCD_SEG_H       (1u << 8)
+#define LCD_SEG_J       (1u << 9)
+#define LCD_SEG_K       (1u << 10)
+#define LCD_SEG_L       (1u << 11)
+#define LCD_SEG_M       (1u << 12)
+#define LCD_SEG_N       (1u << 13)
+#define LCD_SEG_DP      (1u << 14)
+#define LCD_SEG_COLON   (1u << 15)
+#define LCD_GLYPH_BITS  16
+
+/* Where a glyph bit of a digit is lit: COM and which of the digit's four
+   SEG lines */
+struct lcd_pos {
+    uint8_t com;
+    uint8_t line;
+};
+
+/* Panel wiring: every digit has four SEG lines and the same COM x line
+   pattern. */
+struct lcd_layout {
+    uint8_t digits;
+    const uint8_t (*seg)[4];                    /* SEG lines of each digit */
+    const struct lcd_pos *wiring;               /* LCD_GLYPH_BITS entries */
+};
+
+/* Glyph of c from the font table in flash; lower case is shown as upper
+   case and characters without a glyph as blanks */
+uint16_t lcd_glyph(char c);
+
+/* Render text into f, one digit per character from the left. A '.' or
+   ':' lights the DP or colon of the digit before it. Digits past the end
+   of the text are blank, text past the last digit is dropped. */
+void lcd_render(struct lcd_frame *f, const struct lcd_layout *layout, const char *text);
+
+/* Bit n set if RAM word n differs between the two frames */
+uint32_t lcd_frame_diff(const struct lcd_frame *shown, const struct lcd_frame *next);
+
+/* Frame rate: ck_div = lcdclk / (2^ps * (16 + div)), frame = ck_div * duty.
+   The pulse-on duration (pon / ck_ps, ck_ps = lcdclk / 2^ps) has to be long
+   enough to charge the panel for the chosen contrast. */
+struct lcd_timing {
+    uint8_t ps;             /* 0-15 */
+    uint8_t div;            /* 0-15, divider 16 + div */
+    uint8_t pon;            /* 0-7 */
+    uint32_t frame_mhz;     /* frame rate, mHz */
+};
+
+/* Pick the lowest frame rate not under min_frame_hz, with the shortest
+   pulse-on time of at least pulse_us: fewer frames and shorter pulses both
+   save power. Returns 0, or -1 if lcdclk cannot reach min_frame_hz. */
+int lcd_timing_select(uint32_t lcdclk_hz, uint32_t coms, uint32_t min_frame_hz,
+                      uint32_t pulse_us, struct lcd_timing *t);
+
+#endif /* LCD_FRAME_H */
@@ -0,0 +1,36 @@
+#include "lcd.h"
+
+/* Board wiring of the glass; kept apart from lcd.c so that the host
+   tools render with the same layout */
+
+/* Four SEG lines per digit, numbered as in the LCD alternate function
+   of each pin (datasheet pin definitions) */
+static const uint8_t lcd_segs[4][4] = {
+    {  7,  8,  9, 10 },     /* PB3, PB4, PB5, PB10 */
+    { 11, 12, 13, 14 },     /* PB11-PB14 */
+    { 15, 16, 17, 18 },     /* PB15, PB8, PA15, PC0 */
+    { 19, 20, 21, 24 },     /* PC1, PC2, PC3, PC6 */
+};
+
+/* Glass wiring, the same for every digit: COM and SEG line of each
+   glyph bit */
+static const struct lcd_pos lcd_wiring[LCD_GLYPH_BITS] = {
+    { 3, 1 },   /* A */
+    { 3, 2 },   /* B */
+    { 1, 2 },   /* C */
+    { 0, 1 },   /* D */
+    { 0, 0 },   /* E */
+    { 3, 0 },   /* F */
+    { 2, 0 },   /* G1 */
+    { 2, 3 },   /* G2 */
+    { 2, 1 },   /* H */
+    { 2, 2 },   /* J */
+    { 3, 3 },   /* K */
+    { 1, 0 },   /* L */
+    { 1, 1 },   /* M */
+    { 1, 3 },   /* N */
+    { 0, 2 },   /* DP */
+    { 0, 3 },   /* COLON */
+};
+
+const struct lcd_layout lcd_layout = { 4, lcd_segs, lcd_wiring };
@@ -0,0 +1,181 @@
+#include <string.h>
+
+#include "link.h"
+
+/* CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bytewise without table */
+static uint16_t link_crc16(const uint8_t *p, size_t len){
+
+    uint16_t crc = 0xFFFF;
+
+    while(len--){
+        uint16_t x = (uint16_t)((crc >> 8) ^ *p++);
+
+        x ^= x >> 4;
+        crc = (uint16_t)((crc << 8) ^ (x << 12) ^ (x << 5) ^ x);
+    }
+
+    return crc;
+}
+
+void link_init(struct link *link, uint8_t *rx_buf, uint32_t rx_size,
+               const struct link_command *commands, size_t n_commands,
+               link_write_t write, void *write_ctx){
+
+    memset(link, 0, sizeof(*link));
+    link->rx_buf = rx_buf;
+    link->rx_size = rx_size;
+    link->commands = commands;
+    link->n_commands = n_commands;
+    link->write = write;
+    link->write_ctx = write_ctx;
+}
+
+static void link_dispatch(struct link *link, uint8_t *p, size_t n){
+
+    struct link_frame f;
+    uint16_t crc;
+    int len;
+    size_t i;
+
+    len = cobs_decode(p, n);
+    if(len < LINK_HEADER + LINK_CRC){
+        link->stats.rx_framing_errors++;
+        return;
+    }
+
+    len -= LINK_CRC;
+    crc = (uint16_t)(p[len] | (p[len + 1] << 8));
+    if(crc != link_crc16(p, (size_t)len)){
+        link->stats.rx_crc_errors++;
+        return;
+    }
+
+    f.type = p[0];
+    f.seq = p[1];
+    f.payload = p + LINK_HEADER;
+    f.len = (size_t)len - LINK_HEADER;
+
+    link->stats.rx_frames++;
+    if(link->rx_synced && f.seq != link->rx_seq)
+        link->stats.rx_seq_gaps += (uint8_t)(f.seq - link->rx_seq);
+    link->rx_seq = (uint8_t)(f.seq + 1);
+    link->rx_synced = 1;
+
+    for(i = 0; i < link->n_commands; i++){
+        if(link->commands[i].type == f.type){
+            link->commands[i].handler(link, &f);
+            return;
+        }
+    }
+    link->stats.rx_unknown++;
+}
+
+/* Encoded frame in ring[start, end) */
+static void link_rx_frame(struct link *link, uint32_t start, uint32_t end){
+
+    uint32_t n = (end - start) & (link->rx_size - 1);
+    uint32_t first;
+
+    if(n == 0)
+        return;                     /* back to back delimiters */
+
+    /* longer than any valid frame: the delimiter only showed up after the
+       ring wrapped, or in the same chunk, so link_rx_poll() let it through */
+    if(n >= LINK_MAX_ENCODED){
+        link->stats.rx_framing_errors++;
+        return;
+    }
+
+    if(start < end){
+        link_dispatch(link, &link->rx_buf[start], n);
+        return;
+    }
+
+    first = link->rx_size - start;
+    memcpy(link->rx_scratch, &link->rx_buf[start], first);
+    memcpy(link->rx_scratch + first, link->rx_buf, end);
+    link_dispatch(link, link->rx_scratch, n);
+}
+
+void link_rx_poll(struct link *link, uint32_t head){
+
+    const uint32_t mask = link->rx_size - 1;
+
+    while(link->rx_scan != head){
+        uint32_t scan = link->rx_scan;
+        uint32_t end = head > scan ? head : link->rx_size;
+        uint8_t *z = memchr(&link->rx_buf[scan], 0, end - scan);
+
+        if(z == NULL){
+            link->stats.rx_bytes += end - scan;
+            link->rx_scan = end & mask;
+            /* no delimiter within the longest valid frame */
+            if(((link->rx_scan - link->rx_tail) & mask) >= LINK_MAX_ENCODED){
+                if(!link->rx_discard)
+                    link->stats.rx_framing_errors++;
+                link->rx_discard = 1;
+                link->rx_tail = link->rx_scan;
+            }
+            continue;
+        }
+
+        end = (uint32_t)(z - link->rx_buf);
+        link->stats.rx_bytes += end + 1 - scan;
+        if(!link->rx_discard)
+            link_rx_frame(link, link->rx_tail, end);
+        link->rx_discard = 0;
+        link->rx_tail = link->rx_scan = (end + 1) & mask;
+    }
+}
+
+void link_rx_resync(struct link *link, uint32_t head){
+    link->stats.rx_overruns++;
+    link->rx_tail = link->rx_scan = head;
+    link->rx_discard = 1;
+}
+
+int link_send(struct link *link, uint8_t type, const void *payload, size_t len){
+
+    uint8_t *out;
+    uint16_t crc;
+    size_t n;
+
+    if(len > LINK_MAX_PAYLOAD)
+        return -1;
+
+    link->tx_raw[0] = type;
+    link->tx_raw[1] = link->tx_seq++;
+    memcpy(link->tx_raw + LINK_HEADER, payload, len);
+    len += LINK_HEADER;
+    crc = link_crc16(link->tx_raw, len);
+    link->tx_raw[len++] = (uint8_t)crc;
+    link->tx_raw[len++] = (uint8_t)(crc >> 8);
+
+    out = link->tx_buf[link->tx_index];
+    link->tx_index ^= 1;
+    n = cobs_encode(link->tx_raw, len, out);
+    out[n++] = 0;
+
+    link->stats.tx_frames++;
+    link->stats.tx_bytes += n;
+    link->write(out, n, link->write_ctx);
+
+    return 0;
+}
+
+void link_telemetry_add(struct link *link, uint8_t id, uint32_t value){
+
+    if(link->batch_len + LINK_TM_RECORD > sizeof(link->batch))
+        link_telemetry_flush(link);
+
+    link->batch[link->batch_len] = id;
+    link_put_u32(&link->batch[link->batch_len + 1], value);
+    link->batch_len += LINK_TM_RECORD;
+}
+
+void link_telemetry_flush(struct link *link){
+    if(link->batch_len == 0)
+        return;
+    link_send(link, LINK_TELEMETRY, link->batch, link->batch_len);
+    link->batch_len = 0;
+}
@@ -0,0 +1,146 @@
+#ifndef LINK_H
+#define LINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cobs.h"
+
+/* Binary command/telemetry link. Frames are
+       type(1) seq(1) payload(0..LINK_MAX_PAYLOAD) crc16(2, little endian)
+   COBS encoded and terminated by 0x00. The CRC is CRC-16/CCITT-FALSE over
+   type, seq and payload. Each side numbers its frames with its own
+   sequence counter so the peer can count lost frames.
+
+   This file has no hardware dependencies: the firmware feeds it from a DMA
+   ring (src/link_uart.c), the host tools from a serial port or memory. */
+
+#define LINK_MAX_PAYLOAD    250
+#define LINK_HEADER         2
+#define LINK_CRC            2
+#define LINK_MAX_FRAME      (LINK_HEADER + LINK_MAX_PAYLOAD + LINK_CRC)
+/* encoded frame plus the delimiter */
+#define LINK_MAX_ENCODED    (COBS_MAX_ENCODED(LINK_MAX_FRAME) + 1)
+
+/* Frame types; replies have bit 7 set */
+#define LINK_PING           0x01    /* payload echoed in LINK_PONG */
+#define LINK_GET_STATS      0x02    /* answered with LINK_STATS */
+#define LINK_UPDATE_BEGIN   0x10    /* start a delta update of the other slot */
+#define LINK_UPDATE_DATA    0x11    /* next chunk of the delta stream */
+#define LINK_UPDATE_END     0x12    /* check the new image, boot it on trial */
+#define LINK_PONG           0x81
+#define LINK_STATS          0x82    /* struct link_stats, u32 little endian */
+#define LINK_UPDATE_ACK     0x83    /* status(1, signed) bytes accepted(4) */
+#define LINK_TELEMETRY      0x90    /* records: id(1) value(4, little endian) */
+
+/* Telemetry record ids */
+#define LINK_TM_UPTIME      0x01    /* ms */
+#define LINK_TM_STACK_PEAK  0x02    /* bytes */
+#define LINK_TM_RX_FRAMES   0x03
+#define LINK_TM_RX_CYCLES   0x04    /* CPU cycles per received byte, x100 */
+
+#define LINK_TM_RECORD      5
+
+/* Counters, all uint32_t so they can be sent as is */
+struct link_stats {
+    uint32_t rx_frames;
+    uint32_t rx_bytes;
+    uint32_t rx_crc_errors;
+    uint32_t rx_framing_errors;     /* bad COBS, too short or too long */
+    uint32_t rx_unknown;            /* no handler for the type */
+    uint32_t rx_seq_gaps;           /* frames missing according to seq */
+    uint32_t rx_overruns;           /* ring overwritten before parsing */
+    uint32_t rx_cycles;             /* parse time, filled by the port */
+    uint32_t tx_frames;
+    uint32_t tx_bytes;
+};
+
+#define LINK_STATS_WORDS (sizeof(struct link_stats) / sizeof(uint32_t))
+
+struct link;
+
+/* A received frame; payload points into the receive buffer and is only
+   valid during the handler call */
+struct link_frame {
+    uint8_t type;
+    uint8_t seq;
+    const uint8_t *payload;
+    size_t len;
+};
+
+typedef void (*link_handler_t)(struct link *link, const struct link_frame *frame);
+
+/* Command dispatch table entry */
+struct link_command {
+    uint8_t type;
+    link_handler_t handler;
+};
+
+/* Transport: send len bytes. buf stays untouched until the next call,
+   so the port may transmit it asynchronously (DMA). */
+typedef void (*link_write_t)(const uint8_t *buf, size_t len, void *ctx);
+
+struct link {
+    /* receive ring, written by the transport, parsed in place */
+    uint8_t *rx_buf;
+    uint32_t rx_size;               /* power of two, > LINK_MAX_ENCODED */
+    uint32_t rx_tail;               /* first byte of the pending frame */
+    uint32_t rx_scan;               /* next byte to look at */
+    uint8_t rx_discard;             /* drop everything up to the next 0x00 */
+    uint8_t rx_synced;              /* rx_seq is valid */
+    uint8_t rx_seq;                 /* next expected sequence number */
+    uint8_t rx_scratch[LINK_MAX_ENCODED];  /* only for frames that wrap */
+
+    const struct link_command *commands;
+    size_t n_commands;
+
+    /* transmit, encoded frames alternate between the two buffers */
+    link_write_t write;
+    void *write_ctx;
+    uint8_t tx_seq;
+    uint8_t tx_index;
+    uint8_t tx_raw[LINK_MAX_FRAME];
+    uint8_t tx_buf[2][LINK_MAX_ENCODED];
+
+    /* telemetry batch, sent as one LINK_TELEMETRY frame */
+    uint8_t batch[LINK_MAX_PAYLOAD];
+    size_t batch_len;
+
+    struct link_stats stats;
+};
+
+void link_init(struct link *link, uint8_t *rx_buf, uint32_t rx_size,
+               const struct link_command *commands, size_t n_commands,
+               link_write_t write, void *write_ctx);
+
+/* Parse everything the transport wrote up to ring index head and dispatch
+   the complete frames. Frames are decoded in place in the ring; only one
+   that wraps around the end is copied first. */
+void link_rx_poll(struct link *link, uint32_t head);
+
+/* Data was lost (ring overrun): skip to head and resynchronize on the next
+   delimiter */
+void link_rx_resync(struct link *link, uint32_t head);
+
+/* Send one frame. Returns 0, or -1 if len exceeds LINK_MAX_PAYLOAD. */
+int link_send(struct link *link, uint8_t type, const void *payload, size_t len);
+
+/* Append a telemetry record, sending the batch first if it is full */
+void link_telemetry_add(struct link *link, uint8_t id, uint32_t value);
+/* Send the pending records, if any */
+void link_telemetry_flush(struct link *link);
+
+/* Little endian helpers for payloads */
+static inline void link_put_u32(uint8_t *p, uint32_t v){
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t link_get_u32(const uint8_t *p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#endif /* LINK_H */
@@ -0,0 +1,122 @@
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "link_uart.h"
+
+#define LINK_RX_MASK (LINK_RX_SIZE - 1)
+
+static uint8_t link_rx_ring[LINK_RX_SIZE];
+static struct link link_uart;
+
+/* Bytes written by the DMA, counted at each half/full transfer */
+static volatile uint32_t link_rx_written;
+/* Bytes handed to the parser, same scale */
+static uint32_t link_rx_consumed;
+
+static void link_uart_write(const uint8_t *buf, size_t len, void *ctx){
+
+    (void)ctx;
+
+    /* the previous frame, in the other buffer, must be out first */
+    while(LL_DMA_IsEnabledChannel(DMA1, LL_DMA_CHANNEL_4) &&
+          !LL_DMA_IsActiveFlag_TC4(DMA1))
+        ;
+    LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_4);
+    LL_DMA_ClearFlag_TC4(DMA1);
+    LL_DMA_SetMemoryAddress(DMA1, LL_DMA_CHANNEL_4, (uint32_t)buf);
+    LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_4, len);
+    LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_4);
+}
+
+struct link *link_uart_init(const struct link_command *commands, size_t n_commands){
+
+    LL_GPIO_InitTypeDef GPIO_InitStruct;
+    LL_USART_InitTypeDef USART_InitStruct;
+
+    link_init(&link_uart, link_rx_ring, LINK_RX_SIZE, commands, n_commands,
+              link_uart_write, NULL);
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOB);
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+    LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_USART1);
+
+    /* PB6 = TX, PB7 = RX, both AF7; PA9/PA10 are LCD COM1/COM2 */
+    LL_GPIO_StructInit(&GPIO_InitStruct);
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_6 | LL_GPIO_PIN_7;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;
+    GPIO_InitStruct.Alternate = LL_GPIO_AF_7;
+    LL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    /* RX: circular, the ring index is LINK_RX_SIZE - CNDTR */
+    LL_DMA_ConfigTransfer(DMA1, LL_DMA_CHANNEL_5,
+                          LL_DMA_DIRECTION_PERIPH_TO_MEMORY | LL_DMA_PRIORITY_HIGH |
+                          LL_DMA_MODE_CIRCULAR | LL_DMA_PERIPH_NOINCREMENT |
+                          LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_BYTE |
+                          LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_ConfigAddresses(DMA1, LL_DMA_CHANNEL_5, LL_USART_DMA_GetRegAddr(USART1),
+                           (uint32_t)link_rx_ring, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_5, LINK_RX_SIZE);
+    /* both interrupts in one write, LL_DMA_EnableIT_xx() are a RMW each */
+    SET_BIT(DMA1_Channel5->CCR, DMA_CCR_HTIE | DMA_CCR_TCIE);
+    NVIC_SetPriority(DMA1_Channel5_IRQn, 1);
+    NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+    LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_5);
+
+    /* TX: one shot per frame, started by link_uart_write() */
+    LL_DMA_ConfigTransfer(DMA1, LL_DMA_CHANNEL_4,
+                          LL_DMA_DIRECTION_MEMORY_TO_PERIPH | LL_DMA_PRIORITY_MEDIUM |
+                          LL_DMA_MODE_NORMAL | LL_DMA_PERIPH_NOINCREMENT |
+                          LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_BYTE |
+                          LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_SetPeriphAddress(DMA1, LL_DMA_CHANNEL_4, LL_USART_DMA_GetRegAddr(USART1));
+
+    LL_USART_StructInit(&USART_InitStruct);
+    USART_InitStruct.BaudRate = LINK_BAUDRATE;
+    USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
+    LL_USART_Init(USART1, &USART_InitStruct);
+    SET_BIT(USART1->CR3, USART_CR3_DMAR | USART_CR3_DMAT);
+    LL_USART_Enable(USART1);
+
+    /* cycle counter for the parse cost */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return &link_uart;
+}
+
+void DMA1_Channel5_IRQHandler(void){
+    if(LL_DMA_IsActiveFlag_HT5(DMA1)){
+        LL_DMA_ClearFlag_HT5(DMA1);
+        link_rx_written += LINK_RX_SIZE / 2;
+    }
+    if(LL_DMA_IsActiveFlag_TC5(DMA1)){
+        LL_DMA_ClearFlag_TC5(DMA1);
+        link_rx_written += LINK_RX_SIZE / 2;
+    }
+}
+
+void link_uart_poll(void){
+
+    uint32_t written, head, total, start;
+
+    /* written first: if a half boundary is crossed in between, head is
+       still less than a full ring ahead of it */
+    written = link_rx_written;
+    head = (LINK_RX_SIZE - LL_DMA_GetDataLength(DMA1, LL_DMA_CHANNEL_5)) & LINK_RX_MASK;
+    total = written + ((head - written) & LINK_RX_MASK);
+
+    if(total == link_rx_consumed)
+        return;
+
+    start = DWT->CYCCNT;
+    if(total - link_rx_consumed >= LINK_RX_SIZE)
+        link_rx_resync(&link_uart, head);
+    else
+        link_rx_poll(&link_uart, head);
+    link_uart.stats.rx_cycles += DWT->CYCCNT - start;
+
+    link_rx_consumed = total;
+}
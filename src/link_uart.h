@@ -0,0 +1,22 @@
+#ifndef LINK_UART_H
+#define LINK_UART_H
+
+#include "link.h"
+
+/* Link transport on USART1 (PB6 TX / PB7 RX): DMA1 channel 5 receives
+   into a circular buffer, channel 4 sends the encoded frames. */
+
+#define LINK_BAUDRATE 460800
+/* About 22 ms of traffic at full rate: link_uart_poll() must run at least
+   that often or data is lost (counted as rx_overruns) */
+#define LINK_RX_SIZE  1024
+
+/* Set up the USART and DMA and return the link, commands are dispatched
+   from link_uart_poll() */
+struct link *link_uart_init(const struct link_command *commands, size_t n_commands);
+
+/* Parse what the DMA received since the last call; the time spent is
+   added to stats.rx_cycles */
+void link_uart_poll(void);
+
+#endif /* LINK_UART_H */
@@ -0,0 +1,48 @@
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "log.h"
+
+void log_init(void){
+
+    LL_GPIO_InitTypeDef GPIO_InitStruct;
+    LL_USART_InitTypeDef USART_InitStruct;
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOA);
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_USART2);
+
+    /* PA2 = TX, PA3 = RX, both AF7 */
+    LL_GPIO_StructInit(&GPIO_InitStruct);
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_2 | LL_GPIO_PIN_3;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_HIGH;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;
+    GPIO_InitStruct.Alternate = LL_GPIO_AF_7;
+    LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    LL_USART_StructInit(&USART_InitStruct);
+    USART_InitStruct.BaudRate = LOG_BAUDRATE;
+    USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
+    LL_USART_Init(USART2, &USART_InitStruct);
+    LL_USART_Enable(USART2);
+}
+
+void log_putc(char c){
+    while(!LL_USART_IsActiveFlag_TXE(USART2))
+        ;
+    LL_USART_TransmitData8(USART2, (uint8_t)c);
+}
+
+void log_puts(const char *s){
+    while(*s)
+        log_putc(*s++);
+}
+
+void log_hex(uint32_t v){
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    log_puts("0x");
+    for(i = 28; i >= 0; i -= 4)
+        log_putc(hex[(v >> i) & 0xF]);
+}
@@ -0,0 +1,17 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+
+/* Blocking text log on USART2, which the Nucleo routes to the ST-LINK
+   virtual COM port (PA2 TX / PA3 RX). */
+
+#define LOG_BAUDRATE 115200
+
+void log_init(void);
+void log_putc(char c);
+void log_puts(const char *s);
+/* Print v as 0x%08x */
+void log_hex(uint32_t v);
+
+#endif /* LOG_H */
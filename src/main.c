@@ -3,6 +3,48 @@
 #include "stm32l1xx.h"
 #include "stm32l1xx_conf.h"
 
+#include "commands.h"
+#include "fault.h"
+#include "lcd.h"
+#include "log.h"
+#include "stack.h"
+#include "tick.h"
+#include "update.h"
+#include "watchdog.h"
+
+/* IWDG timeout and the main loop check-in deadline, in ms */
+#define WATCHDOG_TIMEOUT    2000
+#define MAIN_LOOP_DEADLINE  1000
+/* LED toggle and telemetry period, in ms */
+#define BLINK_PERIOD        250
+
+static void stack_report(uint32_t peak){
+    log_puts("stack: peak ");
+    log_hex(peak);
+    log_puts(" static worst ");
+    log_hex(stack_worst_case());
+    log_puts(" of ");
+    log_hex(stack_size());
+    log_puts("\r\n");
+}
+
+/* Uptime as mm:ss; lcd_show() only writes what changed, so most calls
+   write nothing */
+static void lcd_uptime(uint32_t ms){
+
+    uint32_t s = ms / 1000, m = s / 60 % 100;
+    char text[6];
+
+    s %= 60;
+    text[0] = (char)('0' + m / 10);
+    text[1] = (char)('0' + m % 10);
+    text[2] = ':';
+    text[3] = (char)('0' + s / 10);
+    text[4] = (char)('0' + s % 10);
+    text[5] = '\0';
+    lcd_print(text);
+}
+
 void SystemClock_Config(void){
 
     /* Clock init stuff */ 
@@ -17,9 +59,27 @@ void SystemClock_Config(void){
 
 int main(void){
 
+    uint32_t stack_peak = 0, peak, now, next_blink;
+    int main_task, lcd_ok;
+
     /* Configure the system clock */
     SystemClock_Config();
 
+    /* Log channel first, then report a crash from the previous boot */
+    log_init();
+    fault_init();
+    fault_report();
+    /* before the IWDG: waiting for the LSE can take up to a second */
+    lcd_ok = lcd_init() == 0;
+    if(!lcd_ok)
+        log_puts("lcd: no clock\r\n");
+    watchdog_init(WATCHDOG_TIMEOUT);
+    watchdog_report();
+    tick_init();
+    main_task = watchdog_register("main", MAIN_LOOP_DEADLINE);
+    commands_init();
+    update_init(main_task);
+
     /* Let's pick a pin and toggle it */
 
     /* Use a structure for this (usually for bulk init), you can also use LL functions */   
@@ -39,10 +99,30 @@ int main(void){
     GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;   // make it a push pull
     LL_GPIO_Init(GPIOA, &GPIO_InitStruct);                  // initialize PORT A
  
-    /* Toggle forever */
+    /* Toggle forever; the loop never blocks so the link is served
+       continuously */
+    next_blink = tick_now();
     while(1){
-        LL_mDelay(250);
+        commands_poll();
+
+        now = tick_now();
+        if((int32_t)(now - next_blink) < 0)
+            continue;
+        next_blink += BLINK_PERIOD;
+
         LL_GPIO_TogglePin(GPIOA, LL_GPIO_PIN_5);
+        watchdog_checkin(main_task);
+        update_checkin();
+        commands_telemetry(now);
+        if(lcd_ok)
+            lcd_uptime(now);
+
+        /* Report each new stack high-water mark */
+        peak = stack_peak_usage();
+        if(peak > stack_peak){
+            stack_peak = peak;
+            stack_report(peak);
+        }
     }
 
     return 0;
@@ -0,0 +1,92 @@
+#include "slot.h"
+
+uint32_t image_crc_sw(const uint32_t *words, size_t n, size_t zero_index){
+
+    uint32_t crc = 0xFFFFFFFFu;
+    size_t i;
+    int b;
+
+    for(i = 0; i < n; i++){
+        crc ^= i == zero_index ? 0 : words[i];
+        for(b = 0; b < 32; b++)
+            crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+    }
+
+    return crc;
+}
+
+const struct image_desc *image_desc_get(const uint8_t *base){
+
+    const struct image_desc *d = (const struct image_desc *)(base + IMAGE_DESC_OFFSET);
+
+    return d->magic == IMAGE_MAGIC ? d : NULL;
+}
+
+int image_valid(const uint8_t *base, uint32_t max_size, image_crc_t crc){
+
+    const struct image_desc *d = image_desc_get(base);
+
+    if(d == NULL || d->length > max_size || d->length % 4 != 0 ||
+       d->length < IMAGE_DESC_OFFSET + sizeof(*d))
+        return 0;
+
+    return crc((const uint32_t *)base, d->length / 4, IMAGE_CRC_INDEX) == d->crc;
+}
+
+int slot_select(struct boot_state *st, int (*valid)(int slot, void *ctx), void *ctx){
+
+    int other;
+
+    if(st->magic != BOOT_STATE_MAGIC || st->active >= SLOT_COUNT ||
+       st->previous >= SLOT_COUNT){
+        st->magic = BOOT_STATE_MAGIC;
+        st->active = 0;
+        st->previous = 0;
+        st->trial = 0;
+        st->attempts = 0;
+        st->rollbacks = 0;
+    }
+
+    if(st->trial){
+        if(st->attempts >= BOOT_MAX_ATTEMPTS){
+            /* the new image never confirmed itself */
+            st->active = st->previous;
+            st->trial = 0;
+            st->attempts = 0;
+            st->rollbacks++;
+        } else {
+            st->attempts++;
+        }
+    }
+
+    if(valid((int)st->active, ctx))
+        return (int)st->active;
+
+    other = (int)st->active ^ 1;
+    if(!valid(other, ctx))
+        return -1;
+
+    if(st->trial)
+        st->rollbacks++;
+    st->previous = st->active;
+    st->active = (uint32_t)other;
+    st->trial = 0;
+    st->attempts = 0;
+
+    return other;
+}
+
+void slot_request(struct boot_state *st, int slot){
+    st->previous = st->active;
+    st->active = (uint32_t)slot;
+    st->trial = 1;
+    st->attempts = 0;
+}
+
+int slot_confirm(struct boot_state *st){
+    if(!st->trial)
+        return 0;
+    st->trial = 0;
+    st->attempts = 0;
+    return 1;
+}
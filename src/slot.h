@@ -0,0 +1,86 @@
+#ifndef SLOT_H
+#define SLOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A/B firmware slots: flash layout, image descriptor, boot state and the
+   bootloader's slot selection. No hardware dependencies, so the selection
+   logic and the image checks also run on the host (tools/imgtool.c).
+
+   The layout must match Device/ldscripts/stm32l1xx_boot.ld and
+   stm32l1xx_slot_a.ld / stm32l1xx_slot_b.ld. */
+
+#define BOOT_BASE           0x08000000u
+#define BOOT_SIZE           0x4000u         /* 16K bootloader */
+#define SLOT_A_BASE         0x08004000u
+#define SLOT_B_BASE         0x08022000u
+#define SLOT_SIZE           0x1E000u        /* 120K per slot */
+#define SLOT_COUNT          2
+
+/* Boot state lives in the last 64 bytes of the data EEPROM, as two
+   copies (see src/bootctl.c) */
+#define BOOT_STATE_ADDR     0x08081FC0u
+
+/* Image descriptor, at a fixed offset from the start of every slot image
+   (after the vector table, see .image_desc in sections_flash.ld). The
+   linker leaves length and crc at 0; tools/imgtool.c seals the binary. */
+#define IMAGE_DESC_OFFSET   0x200u
+#define IMAGE_MAGIC         0x31474D49u     /* "IMG1" */
+
+struct image_desc {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t length;        /* bytes, multiple of 4 */
+    uint32_t crc;           /* image CRC, see image_crc_sw() */
+};
+
+/* Image CRC: CRC-32/MPEG-2 over the little endian words of the image, with
+   the descriptor's crc word taken as 0. This is what the STM32 CRC unit
+   computes, so the bootloader checks an image at one word per cycle. */
+typedef uint32_t (*image_crc_t)(const uint32_t *words, size_t n, size_t zero_index);
+
+uint32_t image_crc_sw(const uint32_t *words, size_t n, size_t zero_index);
+
+/* Word index of the crc field */
+#define IMAGE_CRC_INDEX ((IMAGE_DESC_OFFSET + offsetof(struct image_desc, crc)) / 4)
+
+/* Descriptor of an image at base, or NULL */
+const struct image_desc *image_desc_get(const uint8_t *base);
+
+/* Non-zero if the image at base has a descriptor whose length fits
+   max_size and whose CRC matches. base must be 4-byte aligned. */
+int image_valid(const uint8_t *base, uint32_t max_size, image_crc_t crc);
+
+/* Persistent boot state, word sized fields for the EEPROM */
+#define BOOT_STATE_MAGIC    0xB007AB01u
+#define BOOT_MAX_ATTEMPTS   3       /* boots of an unconfirmed image */
+
+struct boot_state {
+    uint32_t magic;
+    uint32_t active;        /* slot to boot */
+    uint32_t previous;      /* slot to fall back to */
+    uint32_t trial;         /* active slot not confirmed yet */
+    uint32_t attempts;      /* boots since the trial started */
+    uint32_t rollbacks;     /* times we fell back, for diagnostics */
+};
+
+#define BOOT_STATE_WORDS (sizeof(struct boot_state) / sizeof(uint32_t))
+
+/* Pick the slot to boot and update st: count trial attempts, roll back to
+   the previous slot once they are exhausted, and switch to the other slot
+   if the chosen image is not valid. valid() is only called for the slots
+   considered. Returns the slot, or -1 if neither holds a valid image. */
+int slot_select(struct boot_state *st, int (*valid)(int slot, void *ctx), void *ctx);
+
+/* Make slot the active one, on trial; the running image stays as fallback */
+void slot_request(struct boot_state *st, int slot);
+
+/* Confirm the active slot after a good boot. Returns non-zero if st changed. */
+int slot_confirm(struct boot_state *st);
+
+static inline uint32_t slot_base(int slot){
+    return slot == 0 ? SLOT_A_BASE : SLOT_B_BASE;
+}
+
+#endif /* SLOT_H */
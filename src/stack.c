@@ -0,0 +1,27 @@
+#include "stack.h"
+
+/* Linker script symbols; only their addresses are meaningful */
+extern uint32_t _sstack[], _estack[];
+extern uint32_t _stack_size[], _stack_worst_case[];
+
+uint32_t stack_high_water(const uint32_t *bottom, const uint32_t *top){
+
+    const uint32_t *p = bottom;
+
+    while(p < top && *p == STACK_PAINT)
+        p++;
+
+    return (uint32_t)(top - p) * sizeof(uint32_t);
+}
+
+uint32_t stack_peak_usage(void){
+    return stack_high_water(_sstack, _estack);
+}
+
+uint32_t stack_size(void){
+    return (uint32_t)(uintptr_t)_stack_size;
+}
+
+uint32_t stack_worst_case(void){
+    return (uint32_t)(uintptr_t)_stack_worst_case;
+}
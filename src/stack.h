@@ -0,0 +1,24 @@
+#ifndef STACK_H
+#define STACK_H
+
+#include <stdint.h>
+
+/* Runtime stack watermark. Reset_Handler fills the reserved stack region
+   (_sstack.._estack, see stm32l1xx_stack.ld) with STACK_PAINT before
+   anything runs; the deepest point reached is the lowest overwritten word.
+   Keep in sync with the literal in startup_stm32l152xe.s. */
+
+#define STACK_PAINT 0xA5A5A5A5u
+
+/* Bytes between top and the lowest word in [bottom, top) that no longer
+   holds STACK_PAINT */
+uint32_t stack_high_water(const uint32_t *bottom, const uint32_t *top);
+
+/* Peak stack usage since reset, in bytes */
+uint32_t stack_peak_usage(void);
+
+/* Size of the reserved stack and the static worst case from the build */
+uint32_t stack_size(void);
+uint32_t stack_worst_case(void);
+
+#endif /* STACK_H */
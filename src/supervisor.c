@@ -0,0 +1,67 @@
+#include <stddef.h>
+
+#include "supervisor.h"
+
+/* a expires before b; valid while the two are less than 2^31 ticks apart */
+#define EXPIRES_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+void supervisor_init(struct supervisor *sv){
+    sv->count = 0;
+    sv->earliest = 0;
+}
+
+static void supervisor_find_earliest(struct supervisor *sv){
+
+    uint32_t i, e = 0;
+
+    for(i = 1; i < sv->count; i++)
+        if(EXPIRES_BEFORE(sv->task[i].expiry, sv->task[e].expiry))
+            e = i;
+    sv->earliest = e;
+}
+
+int supervisor_register(struct supervisor *sv, const char *name,
+                        uint32_t deadline, uint32_t now){
+
+    struct supervisor_task *t;
+
+    if(sv->count >= SUPERVISOR_MAX_TASKS)
+        return -1;
+
+    t = &sv->task[sv->count];
+    t->name = name;
+    t->deadline = deadline;
+    t->expiry = now + deadline;
+    sv->count++;
+    supervisor_find_earliest(sv);
+
+    return (int)(sv->count - 1);
+}
+
+void supervisor_checkin(struct supervisor *sv, int id, uint32_t now){
+
+    if(id < 0 || (uint32_t)id >= sv->count)
+        return;
+
+    sv->task[id].expiry = now + sv->task[id].deadline;
+
+    /* a later expiry only matters if this task was the first to expire */
+    if((uint32_t)id == sv->earliest)
+        supervisor_find_earliest(sv);
+}
+
+int supervisor_alive(const struct supervisor *sv, uint32_t now){
+    return sv->count == 0 ||
+           !EXPIRES_BEFORE(sv->task[sv->earliest].expiry, now);
+}
+
+uint32_t supervisor_expired(const struct supervisor *sv, uint32_t now){
+
+    uint32_t i, mask = 0;
+
+    for(i = 0; i < sv->count; i++)
+        if(EXPIRES_BEFORE(sv->task[i].expiry, now))
+            mask |= 1u << i;
+
+    return mask;
+}
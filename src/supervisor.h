@@ -0,0 +1,41 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdint.h>
+
+/* Liveness supervisor: every registered task must check in within its own
+   deadline. supervisor_alive() is O(1) so it can run on every tick; the
+   earliest expiry is cached and only recomputed when the task that owns
+   it checks in. No hardware dependencies, time is passed in by the caller
+   (ms ticks, wrap-around safe). */
+
+#define SUPERVISOR_MAX_TASKS 8
+
+struct supervisor_task {
+    const char *name;
+    uint32_t deadline;      /* max time between two check-ins */
+    uint32_t expiry;        /* last check-in + deadline */
+};
+
+struct supervisor {
+    struct supervisor_task task[SUPERVISOR_MAX_TASKS];
+    uint32_t count;
+    uint32_t earliest;      /* index of the task expiring first */
+};
+
+void supervisor_init(struct supervisor *sv);
+
+/* Returns the task id, or -1 when the table is full. The deadline starts
+   counting at now. */
+int supervisor_register(struct supervisor *sv, const char *name,
+                        uint32_t deadline, uint32_t now);
+
+void supervisor_checkin(struct supervisor *sv, int id, uint32_t now);
+
+/* Non-zero while every task is within its deadline */
+int supervisor_alive(const struct supervisor *sv, uint32_t now);
+
+/* Bit mask of the tasks past their deadline (diagnostics, O(n)) */
+uint32_t supervisor_expired(const struct supervisor *sv, uint32_t now);
+
+#endif /* SUPERVISOR_H */
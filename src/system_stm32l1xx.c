@@ -96,8 +96,11 @@
 /*!< Uncomment the following line if you need to relocate your vector Table in
      Internal SRAM. */ 
 /* #define VECT_TAB_SRAM */
+#if !defined  (VECT_TAB_OFFSET)
 #define VECT_TAB_OFFSET  0x0 /*!< Vector Table base offset field. 
-                                  This value must be a multiple of 0x200. */
+                                  This value must be a multiple of 0x200.
+                                  Set per A/B slot by the Makefile. */
+#endif /* VECT_TAB_OFFSET */
 /**
   * @}
   */
@@ -0,0 +1,20 @@
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "tick.h"
+#include "watchdog.h"
+
+static volatile uint32_t tick_ms;
+
+void tick_init(void){
+    LL_SYSTICK_EnableIT();
+}
+
+uint32_t tick_now(void){
+    return tick_ms;
+}
+
+void SysTick_Handler(void){
+    tick_ms++;
+    watchdog_service(tick_ms);
+}
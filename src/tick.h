@@ -0,0 +1,13 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include <stdint.h>
+
+/* 1 ms system tick from the SysTick interrupt. LL_Init1msTick() must have
+   configured SysTick; LL_mDelay() keeps working since it only polls
+   COUNTFLAG. */
+
+void tick_init(void);
+uint32_t tick_now(void);
+
+#endif /* TICK_H */
@@ -0,0 +1,176 @@
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "bootctl.h"
+#include "delta.h"
+#include "flash.h"
+#include "log.h"
+#include "update.h"
+#include "watchdog.h"
+
+/* Filled in by tools/imgtool.c after the link; placed at
+   IMAGE_DESC_OFFSET by the .image_desc output section. volatile: length
+   and crc are only known once the binary is sealed, so they must be read
+   from flash instead of folded to the 0 written here. */
+const volatile struct image_desc image_desc __attribute__((section(".image_desc"), used)) = {
+    IMAGE_MAGIC, 1, 0, 0
+};
+
+/* Main loop check-ins before a trial image is confirmed, 10 s at the
+   250 ms loop period: it has to run this long without a watchdog reset or
+   a fault */
+#define UPDATE_CONFIRM_CHECKINS 40
+
+static struct delta_decoder update_dec;
+static int update_active;
+static int update_task = -1;
+static uint32_t update_bytes;
+static uint32_t update_checkins;
+
+int update_running_slot(void){
+
+    uint32_t base = (uint32_t)&image_desc - IMAGE_DESC_OFFSET;
+
+    if(base == SLOT_A_BASE)
+        return 0;
+    if(base == SLOT_B_BASE)
+        return 1;
+    return -1;
+}
+
+void update_init(int watchdog_task){
+    update_task = watchdog_task;
+}
+
+void update_checkin(void){
+
+    struct boot_state st;
+
+    if(update_checkins >= UPDATE_CONFIRM_CHECKINS)
+        return;
+    if(++update_checkins < UPDATE_CONFIRM_CHECKINS || update_running_slot() < 0)
+        return;
+
+    /* healthy for long enough: keep this image */
+    boot_state_read(&st);
+    if(st.magic == BOOT_STATE_MAGIC && slot_confirm(&st)){
+        boot_state_write(&st);
+        log_puts("update: image confirmed\r\n");
+    }
+}
+
+static int update_write(void *ctx, uint32_t block, const uint8_t *data, size_t len){
+
+    uint32_t dest = *(const uint32_t *)ctx;
+
+    /* a SAME run can rewrite many pages in one call */
+    watchdog_checkin(update_task);
+
+    return flash_write_page(dest + block * DELTA_BLOCK, data, len);
+}
+
+static void update_ack(struct link *link, int status){
+
+    uint8_t buf[5];
+
+    buf[0] = (uint8_t)status;
+    link_put_u32(&buf[1], update_bytes);
+    link_send(link, LINK_UPDATE_ACK, buf, sizeof(buf));
+}
+
+void update_begin(struct link *link, const struct link_frame *frame){
+
+    static uint32_t dest;
+    struct boot_state st;
+    int slot = update_running_slot();
+    uint32_t base;
+
+    (void)frame;
+    update_active = 0;
+    update_bytes = 0;
+    if(slot < 0){
+        update_ack(link, UPDATE_ERR_NO_SLOT);
+        return;
+    }
+    /* on trial the other slot is the rollback image: not before
+       update_checkin() has confirmed this one */
+    boot_state_read(&st);
+    if(st.magic == BOOT_STATE_MAGIC && st.trial){
+        update_ack(link, UPDATE_ERR_TRIAL);
+        return;
+    }
+
+    base = slot_base(slot);
+    dest = slot_base(slot ^ 1);
+    delta_decoder_init(&update_dec, (const uint8_t *)base, image_desc.length,
+                       SLOT_SIZE, update_write, &dest);
+    update_active = 1;
+    update_ack(link, UPDATE_OK);
+}
+
+void update_data(struct link *link, const struct link_frame *frame){
+
+    size_t head = 0;
+    int status = DELTA_MORE;
+
+    if(!update_active){
+        update_ack(link, UPDATE_ERR_STATE);
+        return;
+    }
+
+    /* the header on its own first: a delta made against another build is
+       rejected before any of its ops write to the other slot */
+    if(update_bytes < DELTA_HEADER){
+        head = DELTA_HEADER - update_bytes;
+        if(head > frame->len)
+            head = frame->len;
+        status = delta_decode(&update_dec, frame->payload, head);
+        if(status >= 0 && update_bytes + head == DELTA_HEADER &&
+           update_dec.hdr.base_crc != image_desc.crc)
+            status = UPDATE_ERR_BASE;
+    }
+    if(status == DELTA_MORE && frame->len > head)
+        status = delta_decode(&update_dec, frame->payload + head, frame->len - head);
+    update_bytes += frame->len;
+
+    if(status < 0)
+        update_active = 0;
+    update_ack(link, status < 0 ? status : UPDATE_OK);
+}
+
+void update_end(struct link *link, const struct link_frame *frame){
+
+    struct boot_state st;
+    int slot = update_running_slot();
+
+    (void)frame;
+    if(!update_active){
+        update_ack(link, UPDATE_ERR_STATE);
+        return;
+    }
+    update_active = 0;
+
+    if(update_dec.status != DELTA_DONE){
+        update_ack(link, UPDATE_ERR_INCOMPLETE);
+        return;
+    }
+    if(!image_valid((const uint8_t *)slot_base(slot ^ 1), SLOT_SIZE, image_crc_hw)){
+        update_ack(link, UPDATE_ERR_IMAGE);
+        return;
+    }
+
+    boot_state_read(&st);
+    if(st.magic != BOOT_STATE_MAGIC){
+        st.magic = BOOT_STATE_MAGIC;
+        st.active = (uint32_t)slot;
+        st.rollbacks = 0;
+    }
+    slot_request(&st, slot ^ 1);
+    boot_state_write(&st);
+    update_ack(link, UPDATE_OK);
+
+    log_puts("update: rebooting into the new image\r\n");
+    /* let the ACK and the log line get out */
+    LL_mDelay(20);
+    NVIC_SystemReset();
+}
@@ -0,0 +1,34 @@
+#ifndef UPDATE_H
+#define UPDATE_H
+
+#include "link.h"
+
+/* Field update of the inactive A/B slot from a delta (src/delta.c) sent
+   over the link, then a trial boot of the new image. */
+
+/* Status codes in LINK_UPDATE_ACK, delta.h errors are passed as is */
+#define UPDATE_OK               0
+#define UPDATE_ERR_NO_SLOT      (-10)   /* not running from a slot */
+#define UPDATE_ERR_BASE         (-11)   /* delta not made for this image */
+#define UPDATE_ERR_STATE        (-12)   /* no update in progress */
+#define UPDATE_ERR_INCOMPLETE   (-13)
+#define UPDATE_ERR_IMAGE        (-14)   /* new image fails its CRC */
+#define UPDATE_ERR_TRIAL        (-15)   /* running image not confirmed yet */
+
+/* Register as a watchdog task owner: flash writes of a large delta chunk
+   check in on behalf of the caller's loop. */
+void update_init(int watchdog_task);
+
+/* Call from the main loop next to its watchdog check-in. A trial image is
+   confirmed only after it has kept checking in for a while, so one that
+   hangs or faults later in the main loop still rolls back. */
+void update_checkin(void);
+
+/* Slot the running image was linked for, -1 for a standalone build */
+int update_running_slot(void);
+
+void update_begin(struct link *link, const struct link_frame *frame);
+void update_data(struct link *link, const struct link_frame *frame);
+void update_end(struct link *link, const struct link_frame *frame);
+
+#endif /* UPDATE_H */
@@ -0,0 +1,144 @@
+#include "stm32l1xx.h"
+#include "stm32l1xx_conf.h"
+
+#include "log.h"
+#include "supervisor.h"
+#include "tick.h"
+#include "watchdog.h"
+
+/* LSI nominal frequency and the IWDG prescaler we use */
+#define LSI_HZ          37000u
+#define IWDG_DIV        32u
+#define IWDG_RELOAD_MAX 0x0FFFu
+
+/* Tasks that had missed their deadline when the IWDG refresh stopped;
+   kept across the IWDG reset so the next boot can tell who stalled */
+static uint32_t watchdog_stalled __attribute__((section(".noinit")));
+
+static struct supervisor watchdog_sv;
+static uint32_t watchdog_cause;
+static uint8_t wwdg_counter;
+
+static uint32_t watchdog_read_reset_cause(void){
+
+    uint32_t cause = 0;
+
+    if(LL_RCC_IsActiveFlag_PORRST())
+        cause |= RESET_CAUSE_POWER;
+    if(LL_RCC_IsActiveFlag_PINRST())
+        cause |= RESET_CAUSE_PIN;
+    if(LL_RCC_IsActiveFlag_SFTRST())
+        cause |= RESET_CAUSE_SOFTWARE;
+    if(LL_RCC_IsActiveFlag_IWDGRST())
+        cause |= RESET_CAUSE_IWDG;
+    if(LL_RCC_IsActiveFlag_WWDGRST())
+        cause |= RESET_CAUSE_WWDG;
+    if(LL_RCC_IsActiveFlag_LPWRRST())
+        cause |= RESET_CAUSE_LOW_POWER;
+    if(LL_RCC_IsActiveFlag_OBLRST())
+        cause |= RESET_CAUSE_OPTION_BYTE;
+    LL_RCC_ClearResetFlags();
+
+    return cause;
+}
+
+void watchdog_init(uint32_t timeout_ms){
+
+    uint32_t reload;
+
+    watchdog_cause = watchdog_read_reset_cause();
+    /* only meaningful right after an IWDG reset */
+    if(!(watchdog_cause & RESET_CAUSE_IWDG))
+        watchdog_stalled = 0;
+
+    supervisor_init(&watchdog_sv);
+
+    /* Do not let the watchdogs fire while the core is halted by a debugger */
+    LL_DBGMCU_APB1_GRP1_FreezePeriph(LL_DBGMCU_APB1_GRP1_IWDG_STOP |
+                                     LL_DBGMCU_APB1_GRP1_WWDG_STOP);
+
+    reload = timeout_ms * (LSI_HZ / 1000u) / IWDG_DIV;
+    if(reload > IWDG_RELOAD_MAX)
+        reload = IWDG_RELOAD_MAX;
+    if(reload == 0)
+        reload = 1;
+
+    LL_IWDG_Enable(IWDG);                   /* also starts the LSI */
+    LL_IWDG_EnableWriteAccess(IWDG);
+    LL_IWDG_SetPrescaler(IWDG, LL_IWDG_PRESCALER_32);
+    LL_IWDG_SetReloadCounter(IWDG, reload);
+    while(!LL_IWDG_IsReady(IWDG))
+        ;
+    LL_IWDG_ReloadCounter(IWDG);
+}
+
+uint32_t watchdog_reset_cause(void){
+    return watchdog_cause;
+}
+
+void watchdog_report(void){
+
+    static const char *const names[] = {
+        "power", "pin", "software", "iwdg", "wwdg", "low-power", "option-bytes"
+    };
+    uint32_t i;
+
+    log_puts("reset:");
+    for(i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        if(watchdog_cause & (1u << i)){
+            log_putc(' ');
+            log_puts(names[i]);
+        }
+    if(watchdog_cause & RESET_CAUSE_IWDG){
+        log_puts(", stalled tasks ");
+        log_hex(watchdog_stalled);
+    }
+    log_puts("\r\n");
+}
+
+/* The supervisor is shared with the SysTick handler */
+int watchdog_register(const char *name, uint32_t deadline_ms){
+
+    uint32_t primask = __get_PRIMASK();
+    int id;
+
+    __disable_irq();
+    id = supervisor_register(&watchdog_sv, name, deadline_ms, tick_now());
+    __set_PRIMASK(primask);
+
+    return id;
+}
+
+void watchdog_checkin(int id){
+
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    supervisor_checkin(&watchdog_sv, id, tick_now());
+    __set_PRIMASK(primask);
+}
+
+void watchdog_service(uint32_t now){
+    if(supervisor_alive(&watchdog_sv, now)){
+        LL_IWDG_ReloadCounter(IWDG);
+        watchdog_stalled = 0;
+    } else {
+        /* stop refreshing and leave a note for the next boot */
+        watchdog_stalled = supervisor_expired(&watchdog_sv, now);
+    }
+}
+
+void watchdog_wwdg_start(uint32_t prescaler, uint8_t window, uint8_t counter){
+
+    wwdg_counter = counter;
+
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_WWDG);
+    LL_WWDG_SetPrescaler(WWDG, prescaler);
+    LL_WWDG_SetWindow(WWDG, window);
+    LL_WWDG_SetCounter(WWDG, counter);
+    LL_WWDG_Enable(WWDG);
+}
+
+void watchdog_wwdg_refresh(void){
+    LL_WWDG_SetCounter(WWDG, wwdg_counter);
+}
@@ -0,0 +1,47 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+
+/* Watchdog supervision. The IWDG is refreshed from the tick only while
+   every task registered with watchdog_register() has checked in within its
+   deadline, so a single stalled loop resets the part. The WWDG can be added
+   for a timing-critical loop that must refresh it inside a window. */
+
+/* Causes of the last reset, from RCC->CSR */
+enum reset_cause {
+    RESET_CAUSE_POWER       = 1u << 0,  /* power-on/power-down */
+    RESET_CAUSE_PIN         = 1u << 1,  /* NRST pin */
+    RESET_CAUSE_SOFTWARE    = 1u << 2,  /* NVIC_SystemReset(), e.g. after a fault */
+    RESET_CAUSE_IWDG        = 1u << 3,
+    RESET_CAUSE_WWDG        = 1u << 4,
+    RESET_CAUSE_LOW_POWER   = 1u << 5,
+    RESET_CAUSE_OPTION_BYTE = 1u << 6
+};
+
+/* Latch and clear the reset flags, then start the IWDG with roughly
+   timeout_ms (LSI is not trimmed, expect +-40%). Up to about 3500 ms. */
+void watchdog_init(uint32_t timeout_ms);
+
+/* Mask of enum reset_cause for the current boot */
+uint32_t watchdog_reset_cause(void);
+
+/* Log the reset cause and, after an IWDG reset, which tasks had stalled */
+void watchdog_report(void);
+
+/* Register a task that must call watchdog_checkin() at least every
+   deadline_ms. Returns its id, -1 if the table is full. */
+int watchdog_register(const char *name, uint32_t deadline_ms);
+void watchdog_checkin(int id);
+
+/* Called from the tick: refreshes the IWDG if all tasks are alive */
+void watchdog_service(uint32_t now);
+
+/* Start the WWDG: counter (0x40..0x7F) is reloaded by
+   watchdog_wwdg_refresh(), which must happen once the down-counter has
+   fallen below window and before it reaches 0x3F.
+   Period per count is 4096 * prescaler / PCLK1. */
+void watchdog_wwdg_start(uint32_t prescaler, uint8_t window, uint8_t counter);
+void watchdog_wwdg_refresh(void);
+
+#endif /* WATCHDOG_H */
@@ -79,6 +79,19 @@ defined in linker script */
   .type Reset_Handler, %function
 Reset_Handler:
 
+/* Paint the reserved stack (up to the current sp) with STACK_PAINT from
+   stack.h, so that stack_peak_usage() can find the high-water mark */
+  ldr r2, =_sstack
+  ldr r3, =0xA5A5A5A5
+  mov r0, sp
+  b LoopPaintStack
+PaintStack:
+  str r3, [r2], #4
+
+LoopPaintStack:
+  cmp r2, r0
+  bcc PaintStack
+
 /* Copy the data segment initializers from flash to SRAM */
   movs r1, #0
   b LoopCopyDataInit
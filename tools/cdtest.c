@@ -0,0 +1,157 @@
+/*
+ * Host round-trip test of the crash dump record (src/crashdump.c).
+ *
+ *   cdtest
+ *
+ * Captures records from a fake exception frame, with and without the
+ * alignment pad word, encodes every line, and decodes them again through a
+ * log prefix. A corrupted word and a missing line have to be caught.
+ * Exits with 1 on the first failure.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "crashdump.h"
+
+static int failures;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(int ok, const char *what, int line){
+    if(!ok){
+        fprintf(stderr, "cdtest:%d: %s\n", line, what);
+        failures++;
+    }
+}
+
+#define LINES_MAX 32
+#define LINE_SIZE 128
+
+/* All lines of d, up to and including "@CD END"; returns the count */
+static unsigned encode(const struct crashdump *d, char lines[][LINE_SIZE]){
+
+    unsigned n = 0;
+
+    while(n < LINES_MAX && crashdump_encode_line(d, n, lines[n], LINE_SIZE) > 0)
+        n++;
+
+    return n;
+}
+
+/* Feed the lines after a log prefix, skipping line `skip` (-1: none) and
+   with the first byte of line `bad` (-1: none) replaced by c */
+static enum crashdump_status decode(struct crashdump *d, char lines[][LINE_SIZE], unsigned n,
+                                    int skip, int bad, char c){
+
+    enum crashdump_status st = CRASHDUMP_IGNORED;
+    char buf[LINE_SIZE + 32];
+    unsigned i;
+
+    CHECK(crashdump_decode_line(d, "boot: reset cause pin") == CRASHDUMP_IGNORED);
+    for(i = 0; i < n; i++){
+        if((int)i == skip)
+            continue;
+        snprintf(buf, sizeof(buf), "[%5u.%03u] %s", i, i * 7, lines[i]);
+        if((int)i == bad)
+            buf[strlen(buf) - 1] = c;
+        st = crashdump_decode_line(d, buf);
+        if(st == CRASHDUMP_ERROR)
+            break;
+        if(i + 1 < n)
+            CHECK(st == CRASHDUMP_PARTIAL);
+    }
+
+    return st;
+}
+
+static void test_capture(int pad){
+
+    uint32_t stack[64];
+    const uint32_t *sp = stack + CD_FRAME_WORDS + pad;
+    struct crashdump_fsr fsr = { 0x00008200u, 0x40000000u, 0, 0x20005000u };
+    struct crashdump d;
+    uint32_t i;
+
+    for(i = 0; i < 64; i++)
+        stack[i] = 0x20000000u + i * 0x111u;
+    stack[CD_PC] = 0x08004321u;
+    stack[CD_XPSR] = 0x01000003u | ((uint32_t)pad << 9);
+
+    /* more stack than the record holds */
+    crashdump_capture(&d, stack, 0xFFFFFFF9u, 3, &fsr, stack + 64);
+    CHECK(crashdump_valid(&d));
+    CHECK(d.frame[CD_PC] == 0x08004321u && d.exception == 3);
+    CHECK(d.fsr.cfsr == fsr.cfsr && d.fsr.bfar == fsr.bfar);
+    CHECK(d.sp == (uint32_t)(uintptr_t)sp);
+    CHECK(d.stack_words == CRASHDUMP_STACK_WORDS);
+    CHECK(memcmp(d.stack, sp, CRASHDUMP_STACK_WORDS * 4) == 0);
+
+    /* a few words to the top: the rest is zero */
+    crashdump_capture(&d, stack, 0xFFFFFFFDu, 4, &fsr, sp + 5);
+    CHECK(crashdump_valid(&d));
+    CHECK(d.stack_words == 5);
+    CHECK(memcmp(d.stack, sp, 5 * 4) == 0);
+    for(i = 5; i < CRASHDUMP_STACK_WORDS; i++)
+        CHECK(d.stack[i] == 0);
+
+    /* sp at or past the top */
+    crashdump_capture(&d, stack, 0xFFFFFFF9u, 5, &fsr, sp);
+    CHECK(crashdump_valid(&d) && d.stack_words == 0);
+
+    crashdump_clear(&d);
+    CHECK(!crashdump_valid(&d));
+}
+
+static void test_round_trip(int pad){
+
+    static char lines[LINES_MAX][LINE_SIZE];
+    uint32_t stack[64];
+    struct crashdump_fsr fsr = { 0x00000400u, 0x40000000u, 0xE000ED34u, 0 };
+    struct crashdump d, out;
+    unsigned n, i;
+
+    for(i = 0; i < 64; i++)
+        stack[i] = 0xA5000000u ^ (i * 0x01010101u);
+    stack[CD_XPSR] = 0x21000000u | ((uint32_t)pad << 9);
+    crashdump_capture(&d, stack, 0xFFFFFFE9u, 5, &fsr, stack + 40);
+
+    n = encode(&d, lines);
+    CHECK(n == (CRASHDUMP_WORDS + CRASHDUMP_LINE_WORDS - 1) / CRASHDUMP_LINE_WORDS + 1);
+    CHECK(strcmp(lines[n - 1], CRASHDUMP_TAG " END") == 0);
+    for(i = 0; i < n; i++)
+        CHECK(strncmp(lines[i], CRASHDUMP_TAG " ", sizeof(CRASHDUMP_TAG)) == 0 &&
+              strlen(lines[i]) < 100);
+
+    CHECK(decode(&out, lines, n, -1, -1, 0) == CRASHDUMP_DONE);
+    CHECK(memcmp(&out, &d, sizeof(d)) == 0);
+
+    /* a word that is no longer hex is a malformed line */
+    CHECK(decode(&out, lines, n, -1, 1, 'x') == CRASHDUMP_ERROR);
+    /* still hex but wrong, or a line lost: the CRC catches it at END */
+    CHECK(decode(&out, lines, n, -1, 1, lines[1][strlen(lines[1]) - 1] == '0' ? '1' : '0') ==
+          CRASHDUMP_ERROR);
+    CHECK(decode(&out, lines, n, 2, -1, 0) == CRASHDUMP_ERROR);
+    CHECK(decode(&out, lines, n, (int)n - 2, -1, 0) == CRASHDUMP_ERROR);
+
+    /* a complete dump after a broken one still decodes */
+    CHECK(decode(&out, lines, n, -1, -1, 0) == CRASHDUMP_DONE);
+    CHECK(memcmp(&out, &d, sizeof(d)) == 0);
+}
+
+int main(void){
+
+    int pad;
+
+    for(pad = 0; pad <= 1; pad++){
+        test_capture(pad);
+        test_round_trip(pad);
+    }
+
+    if(failures){
+        fprintf(stderr, "cdtest: %d failures\n", failures);
+        return 1;
+    }
+    printf("cdtest: ok\n");
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Host side decoder for the crash dumps printed at boot by fault_report().
+ *
+ *   crashdecode project.elf [logfile]
+ *
+ * Reads the log (stdin by default), rebuilds the last complete dump using
+ * the same code as the firmware (src/crashdump.c) and resolves pc, lr and
+ * code addresses found in the stack snapshot against the ELF symbols with
+ * arm-none-eabi-addr2line.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crashdump.h"
+
+#define FLASH_START 0x08000000u
+#define FLASH_END   0x08040000u
+
+static const char *addr2line = "arm-none-eabi-addr2line";
+
+static void print_symbol(const char *elf, uint32_t addr){
+
+    char cmd[512];
+    char out[256];
+    FILE *p;
+
+    /* strip the Thumb bit; lr/return addresses point after the call */
+    addr &= ~1u;
+    snprintf(cmd, sizeof(cmd), "%s -f -p -C -e '%s' 0x%08x 2>/dev/null",
+             addr2line, elf, (unsigned)addr);
+    p = popen(cmd, "r");
+    if(p == NULL || fgets(out, sizeof(out), p) == NULL){
+        printf("?\n");
+    } else {
+        printf("%s", out);
+    }
+    if(p != NULL)
+        pclose(p);
+}
+
+static int is_code(uint32_t v){
+    return v >= FLASH_START && v < FLASH_END && (v & 1);
+}
+
+struct bit_name {
+    uint32_t mask;
+    const char *name;
+};
+
+static const struct bit_name cfsr_bits[] = {
+    { 1u << 0,  "IACCVIOL (instruction access violation)" },
+    { 1u << 1,  "DACCVIOL (data access violation)" },
+    { 1u << 3,  "MUNSTKERR (MemManage on exception return)" },
+    { 1u << 4,  "MSTKERR (MemManage on exception entry)" },
+    { 1u << 7,  "MMARVALID (MMFAR holds the fault address)" },
+    { 1u << 8,  "IBUSERR (instruction bus error)" },
+    { 1u << 9,  "PRECISERR (precise data bus error)" },
+    { 1u << 10, "IMPRECISERR (imprecise data bus error)" },
+    { 1u << 11, "UNSTKERR (BusFault on exception return)" },
+    { 1u << 12, "STKERR (BusFault on exception entry, stack overflow?)" },
+    { 1u << 15, "BFARVALID (BFAR holds the fault address)" },
+    { 1u << 16, "UNDEFINSTR (undefined instruction)" },
+    { 1u << 17, "INVSTATE (invalid EPSR state, Thumb bit clear?)" },
+    { 1u << 18, "INVPC (invalid EXC_RETURN)" },
+    { 1u << 19, "NOCP (no coprocessor)" },
+    { 1u << 24, "UNALIGNED (unaligned access)" },
+    { 1u << 25, "DIVBYZERO (divide by zero)" },
+    { 0, NULL }
+};
+
+static const struct bit_name hfsr_bits[] = {
+    { 1u << 1,  "VECTTBL (vector table read fault)" },
+    { 1u << 30, "FORCED (escalated configurable fault)" },
+    { 1u << 31, "DEBUGEVT (debug event)" },
+    { 0, NULL }
+};
+
+static void print_bits(const char *reg, uint32_t v, const struct bit_name *b){
+    printf("%-6s 0x%08x\n", reg, (unsigned)v);
+    for(; b->name != NULL; b++)
+        if(v & b->mask)
+            printf("         %s\n", b->name);
+}
+
+static const char *exception_name(uint32_t n){
+    switch(n){
+    case 3: return "HardFault";
+    case 4: return "MemManage";
+    case 5: return "BusFault";
+    case 6: return "UsageFault";
+    default: return "?";
+    }
+}
+
+static void print_dump(const char *elf, const struct crashdump *d){
+
+    static const char *const reg[CD_FRAME_WORDS] = {
+        "r0", "r1", "r2", "r3", "r12", "lr", "pc", "xpsr"
+    };
+    uint32_t i;
+
+    printf("exception %u (%s), EXC_RETURN 0x%08x, %s stack\n",
+           (unsigned)d->exception, exception_name(d->exception),
+           (unsigned)d->exc_return, (d->exc_return & 4) ? "process" : "main");
+    for(i = 0; i < CD_FRAME_WORDS; i++)
+        printf("%-6s 0x%08x\n", reg[i], (unsigned)d->frame[i]);
+    printf("sp     0x%08x\n", (unsigned)d->sp);
+    print_bits("cfsr", d->fsr.cfsr, cfsr_bits);
+    print_bits("hfsr", d->fsr.hfsr, hfsr_bits);
+    if(d->fsr.cfsr & (1u << 7))
+        printf("mmfar  0x%08x\n", (unsigned)d->fsr.mmfar);
+    if(d->fsr.cfsr & (1u << 15))
+        printf("bfar   0x%08x\n", (unsigned)d->fsr.bfar);
+
+    printf("\npc: ");
+    print_symbol(elf, d->frame[CD_PC] | 1);
+    printf("lr: ");
+    print_symbol(elf, d->frame[CD_LR]);
+
+    printf("\nstack (%u words from sp):\n", (unsigned)d->stack_words);
+    for(i = 0; i < d->stack_words; i++){
+        printf("  [sp+%3u] 0x%08x", (unsigned)(i * 4), (unsigned)d->stack[i]);
+        if(is_code(d->stack[i])){
+            printf("  ");
+            print_symbol(elf, d->stack[i]);
+        } else {
+            printf("\n");
+        }
+    }
+}
+
+int main(int argc, char **argv){
+
+    struct crashdump d, last;
+    char line[256];
+    FILE *in = stdin;
+    int found = 0, errors = 0;
+    const char *env;
+
+    if(argc < 2 || argc > 3){
+        fprintf(stderr, "usage: %s <elf> [logfile]\n", argv[0]);
+        return 2;
+    }
+    if(argc == 3){
+        in = fopen(argv[2], "r");
+        if(in == NULL){
+            perror(argv[2]);
+            return 2;
+        }
+    }
+    env = getenv("ADDR2LINE");
+    if(env != NULL)
+        addr2line = env;
+
+    memset(&d, 0, sizeof(d));
+    while(fgets(line, sizeof(line), in) != NULL){
+        switch(crashdump_decode_line(&d, line)){
+        case CRASHDUMP_DONE:
+            last = d;
+            found = 1;
+            break;
+        case CRASHDUMP_ERROR:
+            errors++;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if(!found){
+        fprintf(stderr, "no complete crash dump found%s\n",
+                errors ? " (corrupted lines seen)" : "");
+        return 1;
+    }
+
+    print_dump(argv[1], &last);
+    return 0;
+}
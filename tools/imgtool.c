@@ -0,0 +1,207 @@
+/*
+ * Host tool for the A/B slot images and delta updates.
+ *
+ *   imgtool seal <in.bin> <out.bin>            pad to 4 bytes, fill in the
+ *                                              image descriptor length/CRC
+ *   imgtool info <image.bin>                   print and check the descriptor
+ *   imgtool delta <base.bin> <new.bin> <out>   block delta base -> new
+ *   imgtool apply <base.bin> <delta> <out.bin> rebuild new from base + delta
+ *   imgtool select <state> <a_valid> <b_valid> run the bootloader's slot
+ *                                              selection on a state given as
+ *                                              active,previous,trial,attempts
+ *
+ * Everything goes through the firmware's own src/slot.c and src/delta.c.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "delta.h"
+#include "slot.h"
+
+static uint8_t *read_file(const char *path, uint32_t *len, uint32_t room){
+
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long n;
+
+    if(f == NULL){
+        perror(path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    /* room for padding; zeroed like erased flash */
+    buf = calloc(1, (size_t)n + room + 4);
+    if(buf == NULL || fread(buf, 1, (size_t)n, f) != (size_t)n){
+        fprintf(stderr, "%s: read error\n", path);
+        exit(1);
+    }
+    fclose(f);
+    *len = (uint32_t)n;
+    return buf;
+}
+
+static void write_file(const char *path, const uint8_t *buf, size_t len){
+
+    FILE *f = fopen(path, "wb");
+
+    if(f == NULL || fwrite(buf, 1, len, f) != len || fclose(f) != 0){
+        perror(path);
+        exit(1);
+    }
+}
+
+static uint32_t image_crc_of(const uint8_t *img, uint32_t len){
+    return image_crc_sw((const uint32_t *)img, len / 4, IMAGE_CRC_INDEX);
+}
+
+static int cmd_seal(const char *in, const char *out){
+
+    uint32_t len;
+    uint8_t *img = read_file(in, &len, 4);
+    struct image_desc *d;
+
+    len = (len + 3) & ~3u;
+    if(len < IMAGE_DESC_OFFSET + sizeof(*d) || len > SLOT_SIZE){
+        fprintf(stderr, "%s: %u bytes, does not fit a slot\n", in, (unsigned)len);
+        return 1;
+    }
+    d = (struct image_desc *)(img + IMAGE_DESC_OFFSET);
+    if(d->magic != IMAGE_MAGIC){
+        fprintf(stderr, "%s: no image descriptor at 0x%x\n", in, IMAGE_DESC_OFFSET);
+        return 1;
+    }
+    d->length = len;
+    d->crc = image_crc_of(img, len);
+    write_file(out, img, len);
+    printf("%s: %u bytes, crc 0x%08x\n", out, (unsigned)len, (unsigned)d->crc);
+    free(img);
+    return 0;
+}
+
+static int cmd_info(const char *path){
+
+    uint32_t len;
+    uint8_t *img = read_file(path, &len, 0);
+    const struct image_desc *d = len >= IMAGE_DESC_OFFSET + sizeof(*d) ?
+                                 image_desc_get(img) : NULL;
+    int ok;
+
+    if(d == NULL){
+        printf("%s: no image descriptor\n", path);
+        return 1;
+    }
+    ok = d->length <= len && image_valid(img, SLOT_SIZE, image_crc_sw);
+    printf("%s: version %u, length %u, crc 0x%08x: %s\n", path, (unsigned)d->version,
+           (unsigned)d->length, (unsigned)d->crc, ok ? "valid" : "INVALID");
+    free(img);
+    return !ok;
+}
+
+static int cmd_delta(const char *base_path, const char *new_path, const char *out){
+
+    uint32_t base_len, new_len;
+    uint8_t *base = read_file(base_path, &base_len, 0);
+    uint8_t *img = read_file(new_path, &new_len, 0);
+    const struct image_desc *bd = image_desc_get(base), *nd = image_desc_get(img);
+    size_t size = DELTA_MAX_SIZE(new_len), n;
+    uint8_t *delta = malloc(size);
+
+    if(bd == NULL || nd == NULL || bd->length != base_len || nd->length != new_len){
+        fprintf(stderr, "both images must be sealed (imgtool seal)\n");
+        return 1;
+    }
+    n = delta_encode(base, base_len, bd->crc, img, new_len, nd->crc, delta, size);
+    write_file(out, delta, n);
+    printf("%s: %u bytes for a %u byte image\n", out, (unsigned)n, (unsigned)new_len);
+    free(base);
+    free(img);
+    free(delta);
+    return 0;
+}
+
+static int apply_write(void *ctx, uint32_t block, const uint8_t *data, size_t len){
+    memcpy((uint8_t *)ctx + block * DELTA_BLOCK, data, len);
+    return 0;
+}
+
+static int cmd_apply(const char *base_path, const char *delta_path, const char *out){
+
+    uint32_t base_len, delta_len;
+    uint8_t *base = read_file(base_path, &base_len, 0);
+    uint8_t *delta = read_file(delta_path, &delta_len, 0);
+    uint8_t *img = calloc(1, SLOT_SIZE);
+    struct delta_decoder dec;
+    int status;
+
+    delta_decoder_init(&dec, base, base_len, SLOT_SIZE, apply_write, img);
+    status = delta_decode(&dec, delta, delta_len);
+    if(status != DELTA_DONE){
+        fprintf(stderr, "%s: decode failed (%d)\n", delta_path, status);
+        return 1;
+    }
+    if(!image_valid(img, SLOT_SIZE, image_crc_sw)){
+        fprintf(stderr, "%s: rebuilt image fails its CRC\n", out);
+        return 1;
+    }
+    write_file(out, img, dec.hdr.target_len);
+    printf("%s: %u bytes, valid\n", out, (unsigned)dec.hdr.target_len);
+    free(base);
+    free(delta);
+    free(img);
+    return 0;
+}
+
+static int select_valid(int slot, void *ctx){
+    return ((const int *)ctx)[slot];
+}
+
+static int cmd_select(const char *state, const char *a, const char *b){
+
+    struct boot_state st;
+    unsigned active, previous, trial, attempts;
+    int valid[SLOT_COUNT], slot;
+
+    if(sscanf(state, "%u,%u,%u,%u", &active, &previous, &trial, &attempts) != 4){
+        fprintf(stderr, "state: active,previous,trial,attempts\n");
+        return 2;
+    }
+    memset(&st, 0, sizeof(st));
+    st.magic = BOOT_STATE_MAGIC;
+    st.active = active;
+    st.previous = previous;
+    st.trial = trial;
+    st.attempts = attempts;
+    valid[0] = atoi(a);
+    valid[1] = atoi(b);
+
+    slot = slot_select(&st, select_valid, valid);
+    printf("boot %d, state %u,%u,%u,%u rollbacks %u\n", slot, (unsigned)st.active,
+           (unsigned)st.previous, (unsigned)st.trial, (unsigned)st.attempts,
+           (unsigned)st.rollbacks);
+    return slot < 0;
+}
+
+int main(int argc, char **argv){
+    if(argc == 4 && strcmp(argv[1], "seal") == 0)
+        return cmd_seal(argv[2], argv[3]);
+    if(argc == 3 && strcmp(argv[1], "info") == 0)
+        return cmd_info(argv[2]);
+    if(argc == 5 && strcmp(argv[1], "delta") == 0)
+        return cmd_delta(argv[2], argv[3], argv[4]);
+    if(argc == 5 && strcmp(argv[1], "apply") == 0)
+        return cmd_apply(argv[2], argv[3], argv[4]);
+    if(argc == 5 && strcmp(argv[1], "select") == 0)
+        return cmd_select(argv[2], argv[3], argv[4]);
+
+    fprintf(stderr,
+            "usage: %s seal <in.bin> <out.bin>\n"
+            "       %s info <image.bin>\n"
+            "       %s delta <base.bin> <new.bin> <out.delta>\n"
+            "       %s apply <base.bin> <in.delta> <out.bin>\n"
+            "       %s select <active,previous,trial,attempts> <a_valid> <b_valid>\n",
+            argv[0], argv[0], argv[0], argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,161 @@
+/*
+ * Host benchmark for the segment LCD frame code (src/lcd_frame.c) with the
+ * board's panel layout.
+ *
+ *   lcdbench [frames]
+ *
+ * Runs text sequences through lcd_render() and lcd_frame_diff() the way
+ * lcd_show() does, writing only the changed words into a simulated
+ * LCD->RAM, and reports the RAM writes per frame against rewriting every
+ * word the panel uses. Each simulated RAM is checked against the rendered
+ * frame; exits with 1 on a mismatch. Also prints the timing lcd_init()
+ * picks for the LSE and the LSI.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lcd.h"
+
+#define LSE_HZ  32768
+#define LSI_HZ  37000
+
+/* keeps the timed diffs from being optimized out */
+static volatile uint32_t sink;
+
+typedef void (*text_fn)(char *buf, size_t size, unsigned frame);
+
+static void seq_counter(char *buf, size_t size, unsigned frame){
+    snprintf(buf, size, "%4u", frame % 10000);
+}
+
+/* mm:ss, one frame per second */
+static void seq_clock(char *buf, size_t size, unsigned frame){
+    snprintf(buf, size, "%02u:%02u", frame / 60 % 100, frame % 60);
+}
+
+static void seq_scroll(char *buf, size_t size, unsigned frame){
+
+    static const char msg[] = "NUCLEO L152 SEGMENT LCD    ";
+    size_t len = sizeof(msg) - 1, i;
+
+    for(i = 0; i < 4 && i + 1 < size; i++)
+        buf[i] = msg[(frame + i) % len];
+    buf[i] = '\0';
+}
+
+static const struct {
+    const char *name;
+    text_fn text;
+} seqs[] = {
+    { "counter", seq_counter },
+    { "clock",   seq_clock },
+    { "scroll",  seq_scroll },
+};
+
+/* RAM words any segment of the panel can be on */
+static unsigned panel_words(const struct lcd_layout *layout){
+
+    uint32_t used = 0;
+    unsigned n = 0;
+    int d, b;
+
+    for(d = 0; d < layout->digits; d++)
+        for(b = 0; b < LCD_GLYPH_BITS; b++){
+            const struct lcd_pos *p = &layout->wiring[b];
+            used |= 1u << (2 * p->com + (layout->seg[d][p->line] >> 5));
+        }
+    for(; used != 0; used >>= 1)
+        n += used & 1;
+
+    return n;
+}
+
+static double now_ns(void){
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int run(const char *name, text_fn text, unsigned frames, unsigned full){
+
+    struct lcd_frame ram, next;
+    uint32_t changed;
+    unsigned f, n, total = 0, max = 0, updates = 0;
+    char buf[16];
+    double t0, t1;
+    int i;
+
+    memset(&ram, 0, sizeof(ram));
+    for(f = 0; f < frames; f++){
+        text(buf, sizeof(buf), f);
+        lcd_render(&next, &lcd_layout, buf);
+        changed = lcd_frame_diff(&ram, &next);
+        for(i = 0, n = 0; changed != 0; i++, changed >>= 1){
+            if(changed & 1){
+                ram.ram[i] = next.ram[i];
+                n++;
+            }
+        }
+        if(memcmp(&ram, &next, sizeof(ram)) != 0){
+            fprintf(stderr, "%s: frame %u \"%s\" differs after the update\n", name, f, buf);
+            return 1;
+        }
+        total += n;
+        updates += n != 0;
+        if(n > max)
+            max = n;
+    }
+
+    /* render + diff only, what lcd_show() costs besides the RAM writes */
+    t0 = now_ns();
+    for(f = 0; f < frames; f++){
+        text(buf, sizeof(buf), f);
+        lcd_render(&next, &lcd_layout, buf);
+        sink |= lcd_frame_diff(&ram, &next);
+        ram = next;
+    }
+    t1 = now_ns();
+
+    printf("%-8s %6u frames  %6u updates  words/frame avg %.2f max %u (panel %u of %d)  "
+           "%.0f ns/frame\n", name, frames, updates, (double)total / frames, max, full,
+           LCD_RAM_WORDS,
+           (t1 - t0) / frames);
+
+    return 0;
+}
+
+static void timing(const char *name, uint32_t hz){
+
+    struct lcd_timing t;
+
+    if(lcd_timing_select(hz, LCD_COMS, LCD_MIN_FRAME_HZ, LCD_PULSE_US, &t) < 0){
+        printf("%s %u Hz: cannot reach %u Hz\n", name, (unsigned)hz, LCD_MIN_FRAME_HZ);
+        return;
+    }
+    printf("%s %u Hz: ps %u div %u pon %u, %u.%03u Hz frame rate\n", name, (unsigned)hz,
+           t.ps, t.div, t.pon, (unsigned)(t.frame_mhz / 1000), (unsigned)(t.frame_mhz % 1000));
+}
+
+int main(int argc, char **argv){
+
+    unsigned frames = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 10000;
+    unsigned full = panel_words(&lcd_layout);
+    size_t i;
+    int err = 0;
+
+    if(frames == 0){
+        fprintf(stderr, "usage: lcdbench [frames]\n");
+        return 2;
+    }
+
+    timing("LSE", LSE_HZ);
+    timing("LSI", LSI_HZ);
+    for(i = 0; i < sizeof(seqs) / sizeof(seqs[0]); i++)
+        err |= run(seqs[i].name, seqs[i].text, frames, full);
+
+    return err;
+}
@@ -0,0 +1,373 @@
+/*
+ * Command line client for the binary link.
+ *
+ *   linkcli [-b baud] <device> ping [count]   round trips, frames/s
+ *   linkcli [-b baud] <device> stats          device link counters
+ *   linkcli [-b baud] <device> monitor        print telemetry frames
+ *   linkcli [-b baud] <device> update <delta> send a delta (tools/imgtool)
+ *                                             to the inactive slot and
+ *                                             reboot into it on trial
+ *   linkcli loopback [frames]                 encoder -> ring -> decoder
+ *                                             in memory, no device
+ *
+ * The loopback runs the firmware's src/link.c on both ends, feeding the
+ * receive ring in irregular chunks so that frames wrap around its end, and
+ * reports throughput in frames/s and ns/byte. It then feeds runs of
+ * non-zero bytes longer than any valid frame, across the end of the ring
+ * and not. It exits non-zero if any frame is lost or corrupted, or an
+ * oversized one is not rejected.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "linkhost.h"
+
+static const char *const stats_names[LINK_STATS_WORDS] = {
+    "rx_frames", "rx_bytes", "rx_crc_errors", "rx_framing_errors",
+    "rx_unknown", "rx_seq_gaps", "rx_overruns", "rx_cycles",
+    "tx_frames", "tx_bytes"
+};
+
+static double now_s(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ---- device commands ---- */
+
+static unsigned pongs;
+static int got_stats;
+static unsigned acks;
+static int ack_status;
+static uint32_t ack_bytes;
+
+static void on_pong(struct link *link, const struct link_frame *f){
+    (void)link;
+    (void)f;
+    pongs++;
+}
+
+static void on_stats(struct link *link, const struct link_frame *f){
+
+    uint32_t i;
+
+    (void)link;
+    for(i = 0; i < LINK_STATS_WORDS && (i + 1) * 4 <= f->len; i++)
+        printf("%-18s %u\n", stats_names[i], (unsigned)link_get_u32(f->payload + i * 4));
+    got_stats = 1;
+}
+
+static void on_update_ack(struct link *link, const struct link_frame *f){
+    (void)link;
+    if(f->len < 5)
+        return;
+    ack_status = (int8_t)f->payload[0];
+    ack_bytes = link_get_u32(f->payload + 1);
+    acks++;
+}
+
+static void on_telemetry(struct link *link, const struct link_frame *f){
+
+    static const char *const names[] = {
+        "?", "uptime_ms", "stack_peak", "rx_frames", "rx_cycles/byte"
+    };
+    size_t i;
+
+    printf("seq %3u gaps %u:", f->seq, (unsigned)link->stats.rx_seq_gaps);
+    for(i = 0; i + LINK_TM_RECORD <= f->len; i += LINK_TM_RECORD){
+        uint8_t id = f->payload[i];
+        uint32_t v = link_get_u32(f->payload + i + 1);
+
+        if(id == LINK_TM_RX_CYCLES)
+            printf(" %s=%u.%02u", names[id], (unsigned)v / 100, (unsigned)v % 100);
+        else
+            printf(" %s=%u", id < sizeof(names) / sizeof(names[0]) ? names[id] : "?",
+                   (unsigned)v);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static const struct link_command host_commands[] = {
+    { LINK_PONG,        on_pong },
+    { LINK_STATS,       on_stats },
+    { LINK_UPDATE_ACK,  on_update_ack },
+    { LINK_TELEMETRY,   on_telemetry },
+};
+
+static int run_ping(struct linkhost *h, unsigned count){
+
+    uint8_t payload[LINK_MAX_PAYLOAD];
+    double t0, dt;
+    unsigned i;
+
+    memset(payload, 0x55, sizeof(payload));
+    t0 = now_s();
+    for(i = 0; i < count; i++){
+        unsigned want = pongs + 1;
+
+        link_send(&h->link, LINK_PING, payload, sizeof(payload));
+        while(pongs < want)
+            if(linkhost_poll(h, 1000) <= 0){
+                fprintf(stderr, "timeout after %u pings\n", i);
+                return 1;
+            }
+    }
+    dt = now_s() - t0;
+    printf("%u round trips in %.3f s: %.1f frames/s each way, %.2f ms per round trip\n",
+           count, dt, count / dt, dt * 1000 / count);
+    return 0;
+}
+
+static int run_stats(struct linkhost *h){
+    link_send(&h->link, LINK_GET_STATS, NULL, 0);
+    while(!got_stats)
+        if(linkhost_poll(h, 1000) <= 0){
+            fprintf(stderr, "no answer\n");
+            return 1;
+        }
+    return 0;
+}
+
+/* Send one update frame and wait for its ACK; flash writes make the
+   device answer DATA frames slowly, so the timeout is generous */
+static int update_step(struct linkhost *h, uint8_t type, const uint8_t *data, size_t len){
+
+    unsigned want = acks + 1;
+
+    link_send(&h->link, type, data, len);
+    while(acks < want)
+        if(linkhost_poll(h, 5000) <= 0){
+            fprintf(stderr, "update: no answer\n");
+            return -1;
+        }
+    if(ack_status != 0){
+        fprintf(stderr, "update: device error %d after %u bytes\n", ack_status,
+                (unsigned)ack_bytes);
+        return -1;
+    }
+    return 0;
+}
+
+static int run_update(struct linkhost *h, const char *path){
+
+    FILE *f = fopen(path, "rb");
+    uint8_t chunk[LINK_MAX_PAYLOAD];
+    size_t n, total = 0;
+    double t0 = now_s();
+
+    if(f == NULL){
+        perror(path);
+        return 1;
+    }
+    if(update_step(h, LINK_UPDATE_BEGIN, NULL, 0) < 0)
+        goto fail;
+    while((n = fread(chunk, 1, sizeof(chunk), f)) > 0){
+        if(update_step(h, LINK_UPDATE_DATA, chunk, n) < 0)
+            goto fail;
+        total += n;
+        printf("\r%u bytes", (unsigned)total);
+        fflush(stdout);
+    }
+    if(update_step(h, LINK_UPDATE_END, NULL, 0) < 0)
+        goto fail;
+    printf("\r%u bytes in %.1f s, device rebooting into the new image\n",
+           (unsigned)total, now_s() - t0);
+    fclose(f);
+    return 0;
+
+fail:
+    fclose(f);
+    return 1;
+}
+
+static int run_monitor(struct linkhost *h){
+    for(;;)
+        if(linkhost_poll(h, -1) < 0){
+            perror("read");
+            return 1;
+        }
+}
+
+/* ---- loopback ---- */
+
+struct loopback {
+    struct link rx;
+    uint8_t ring[1024];
+    uint32_t head;
+    unsigned received, bad;
+    uint8_t expect_seq;
+};
+
+static void loop_frame(struct link *link, const struct link_frame *f){
+
+    struct loopback *lb = (struct loopback *)link;
+    size_t i;
+
+    /* payload pattern derived from seq, see run_loopback() */
+    for(i = 0; i < f->len; i++)
+        if(f->payload[i] != (uint8_t)(f->seq * 7 + i)){
+            lb->bad++;
+            break;
+        }
+    if(f->seq != lb->expect_seq || f->len != (size_t)(f->seq * 37) % (LINK_MAX_PAYLOAD + 1))
+        lb->bad++;
+    lb->expect_seq = (uint8_t)(f->seq + 1);
+    lb->received++;
+}
+
+static const struct link_command loop_commands[] = {
+    { LINK_TELEMETRY, loop_frame },
+};
+
+/* Transport of the sending link: copy into the receiver's ring in chunks
+   of varying size and parse after each, like DMA half/idle events would */
+static void loop_write(const uint8_t *buf, size_t len, void *ctx){
+
+    struct loopback *lb = ctx;
+    static unsigned chunk = 1;
+
+    while(len > 0){
+        size_t n = chunk < len ? chunk : len;
+        size_t room = sizeof(lb->ring) - lb->head;
+
+        if(n > room)
+            n = room;
+        memcpy(&lb->ring[lb->head], buf, n);
+        lb->head = (lb->head + (uint32_t)n) & (sizeof(lb->ring) - 1);
+        buf += n;
+        len -= n;
+        link_rx_poll(&lb->rx, lb->head);
+        chunk = chunk * 5 % 301 + 1;
+    }
+}
+
+/* Next frame of the pattern loop_frame() checks */
+static void loop_send(struct link *tx){
+
+    uint8_t payload[LINK_MAX_PAYLOAD];
+    uint8_t seq = tx->tx_seq;
+    size_t len = (size_t)(seq * 37) % (LINK_MAX_PAYLOAD + 1), j;
+
+    for(j = 0; j < len; j++)
+        payload[j] = (uint8_t)(seq * 7 + j);
+    link_send(tx, LINK_TELEMETRY, payload, len);
+}
+
+/* len non-zero bytes and a delimiter from ring offset tail, parsed in one
+   poll: has to be a framing error that leaves the link intact, and the
+   next frame has to come through */
+static int loop_oversize(struct loopback *lb, struct link *tx, uint32_t tail, size_t len){
+
+    const uint32_t mask = sizeof(lb->ring) - 1;
+    size_t i;
+
+    link_init(&lb->rx, lb->ring, sizeof(lb->ring), loop_commands, 1, NULL, NULL);
+    lb->rx.rx_tail = lb->rx.rx_scan = lb->head = tail;
+    lb->received = lb->bad = 0;
+    lb->expect_seq = tx->tx_seq;
+
+    for(i = 0; i < len; i++)
+        lb->ring[(tail + i) & mask] = 'A';
+    lb->ring[(tail + len) & mask] = 0;
+    lb->head = (uint32_t)(tail + len + 1) & mask;
+    link_rx_poll(&lb->rx, lb->head);
+    loop_send(tx);
+
+    if(lb->rx.commands != loop_commands || lb->rx.n_commands != 1 ||
+       lb->rx.stats.rx_framing_errors != 1 || lb->received != 1 || lb->bad){
+        printf("oversized frame of %u bytes at %u: framing %u received %u\n",
+               (unsigned)len, (unsigned)tail, (unsigned)lb->rx.stats.rx_framing_errors,
+               lb->received);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int run_loopback(unsigned frames){
+
+    static struct loopback lb;
+    static struct link tx;
+    double t0, dt;
+    unsigned i;
+    int oversize;
+
+    link_init(&lb.rx, lb.ring, sizeof(lb.ring), loop_commands, 1, NULL, NULL);
+    link_init(&tx, NULL, 0, NULL, 0, loop_write, &lb);
+
+    t0 = now_s();
+    for(i = 0; i < frames; i++)
+        loop_send(&tx);
+    dt = now_s() - t0;
+
+    printf("%u frames, %u bytes on the wire in %.3f s\n",
+           lb.received, (unsigned)tx.stats.tx_bytes, dt);
+    printf("%.0f frames/s, %.1f MB/s, %.1f ns/byte (encode + decode)\n",
+           frames / dt, tx.stats.tx_bytes / dt / 1e6, dt * 1e9 / tx.stats.tx_bytes);
+    printf("errors: payload %u crc %u framing %u gaps %u\n", lb.bad,
+           (unsigned)lb.rx.stats.rx_crc_errors, (unsigned)lb.rx.stats.rx_framing_errors,
+           (unsigned)lb.rx.stats.rx_seq_gaps);
+
+    if(lb.received != frames || lb.bad || lb.rx.stats.rx_crc_errors ||
+       lb.rx.stats.rx_framing_errors || lb.rx.stats.rx_seq_gaps)
+        return 1;
+
+    /* frames too long to be valid, wrapping the end of the ring and not */
+    oversize = loop_oversize(&lb, &tx, 900, 624);
+    oversize |= loop_oversize(&lb, &tx, 0, 624);
+    oversize |= loop_oversize(&lb, &tx, 900, LINK_MAX_ENCODED);
+    printf("oversized frames: %s\n", oversize ? "FAIL" : "rejected");
+
+    return oversize;
+}
+
+static void usage(const char *prog){
+    fprintf(stderr,
+            "usage: %s [-b baud] <device> ping [count] | stats | monitor | update <delta>\n"
+            "       %s loopback [frames]\n", prog, prog);
+    exit(2);
+}
+
+int main(int argc, char **argv){
+
+    struct linkhost h;
+    int baud = 460800, arg = 1, ret;
+    const char *dev, *cmd;
+
+    if(argc >= 2 && strcmp(argv[1], "loopback") == 0)
+        return run_loopback(argc > 2 ? (unsigned)atoi(argv[2]) : 100000);
+
+    if(argc > 3 && strcmp(argv[1], "-b") == 0){
+        baud = atoi(argv[2]);
+        arg = 3;
+    }
+    if(argc < arg + 2)
+        usage(argv[0]);
+    dev = argv[arg];
+    cmd = argv[arg + 1];
+
+    if(linkhost_open(&h, dev, baud, host_commands,
+                     sizeof(host_commands) / sizeof(host_commands[0])) < 0){
+        perror(dev);
+        return 1;
+    }
+
+    if(strcmp(cmd, "ping") == 0)
+        ret = run_ping(&h, argc > arg + 2 ? (unsigned)atoi(argv[arg + 2]) : 1000);
+    else if(strcmp(cmd, "stats") == 0)
+        ret = run_stats(&h);
+    else if(strcmp(cmd, "monitor") == 0)
+        ret = run_monitor(&h);
+    else if(strcmp(cmd, "update") == 0 && argc > arg + 2)
+        ret = run_update(&h, argv[arg + 2]);
+    else
+        usage(argv[0]);
+
+    linkhost_close(&h);
+    return ret;
+}
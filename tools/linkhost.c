@@ -0,0 +1,109 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "linkhost.h"
+
+static void linkhost_write(const uint8_t *buf, size_t len, void *ctx){
+
+    struct linkhost *h = ctx;
+
+    while(len > 0){
+        ssize_t n = write(h->fd, buf, len);
+
+        if(n < 0){
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static speed_t linkhost_speed(int baud){
+    switch(baud){
+    case 9600:      return B9600;
+    case 19200:     return B19200;
+    case 38400:     return B38400;
+    case 57600:     return B57600;
+    case 115200:    return B115200;
+    case 230400:    return B230400;
+    case 460800:    return B460800;
+    case 921600:    return B921600;
+    default:        return B0;
+    }
+}
+
+int linkhost_open(struct linkhost *h, const char *dev, int baud,
+                  const struct link_command *commands, size_t n_commands){
+
+    struct termios tio;
+    speed_t speed = linkhost_speed(baud);
+
+    if(speed == B0){
+        errno = EINVAL;
+        return -1;
+    }
+
+    h->fd = open(dev, O_RDWR | O_NOCTTY);
+    if(h->fd < 0)
+        return -1;
+
+    if(tcgetattr(h->fd, &tio) < 0){
+        close(h->fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if(tcsetattr(h->fd, TCSANOW, &tio) < 0){
+        close(h->fd);
+        return -1;
+    }
+    tcflush(h->fd, TCIOFLUSH);
+
+    h->head = 0;
+    link_init(&h->link, h->ring, LINKHOST_RX_SIZE, commands, n_commands,
+              linkhost_write, h);
+
+    return 0;
+}
+
+int linkhost_poll(struct linkhost *h, int timeout_ms){
+
+    struct pollfd pfd;
+    size_t room;
+    ssize_t n;
+    int r;
+
+    pfd.fd = h->fd;
+    pfd.events = POLLIN;
+    r = poll(&pfd, 1, timeout_ms);
+    if(r <= 0)
+        return r < 0 && errno != EINTR ? -1 : 0;
+
+    /* contiguous room, at most half the ring per read */
+    room = LINKHOST_RX_SIZE - h->head;
+    if(room > LINKHOST_RX_SIZE / 2)
+        room = LINKHOST_RX_SIZE / 2;
+
+    n = read(h->fd, &h->ring[h->head], room);
+    if(n < 0)
+        return errno == EINTR || errno == EAGAIN ? 0 : -1;
+
+    h->head = (h->head + (uint32_t)n) & (LINKHOST_RX_SIZE - 1);
+    link_rx_poll(&h->link, h->head);
+
+    return (int)n;
+}
+
+void linkhost_close(struct linkhost *h){
+    close(h->fd);
+}
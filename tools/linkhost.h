@@ -0,0 +1,32 @@
+/*
+ * Host side of the binary link (src/link.c) over a serial port. Uses the
+ * same encoder, decoder and dispatch code as the firmware.
+ */
+#ifndef LINKHOST_H
+#define LINKHOST_H
+
+#include "link.h"
+
+/* Host receive ring; large enough that one read never reaches a pending
+   partial frame */
+#define LINKHOST_RX_SIZE 4096
+
+struct linkhost {
+    int fd;
+    struct link link;
+    uint32_t head;
+    uint8_t ring[LINKHOST_RX_SIZE];
+};
+
+/* Open and configure dev (raw 8N1, no flow control). Returns 0 or -1 with
+   errno set. */
+int linkhost_open(struct linkhost *h, const char *dev, int baud,
+                  const struct link_command *commands, size_t n_commands);
+
+/* Wait up to timeout_ms for data, then dispatch the received frames.
+   Returns the number of bytes read, 0 on timeout, -1 on error. */
+int linkhost_poll(struct linkhost *h, int timeout_ms);
+
+void linkhost_close(struct linkhost *h);
+
+#endif /* LINKHOST_H */
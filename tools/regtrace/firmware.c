@@ -0,0 +1,40 @@
+/*
+ * The parts of the firmware that only exist on the target: the linker
+ * script symbols, and src/fault.c, whose entry point is Thumb assembly.
+ * Faults are not simulated.
+ */
+#include <stdint.h>
+
+#include "fault.h"
+#include "stack.h"
+
+#define SIM_STACK_WORDS 1024
+
+/* _sstack.._estack is painted like the startup code does */
+uint32_t _sstack[SIM_STACK_WORDS];
+
+#define STR(x) #x
+#define XSTR(x) STR(x)
+
+__asm__(
+    ".globl _estack\n"
+    ".set _estack, _sstack + 4 * " XSTR(SIM_STACK_WORDS) "\n"
+    ".globl _stack_size\n"
+    ".set _stack_size, 4 * " XSTR(SIM_STACK_WORDS) "\n"
+    ".globl _stack_worst_case\n"
+    ".set _stack_worst_case, 0\n"
+);
+
+__attribute__((constructor)) static void paint_stack(void){
+
+    int i;
+
+    for(i = 0; i < SIM_STACK_WORDS; i++)
+        _sstack[i] = STACK_PAINT;
+}
+
+void fault_init(void){
+}
+
+void fault_report(void){
+}
@@ -0,0 +1,166 @@
+/*
+ * Host stand-in for Drivers/CMSIS/Include/cmsis_gcc.h, found first on the
+ * include path when the firmware is built for tools/regtrace. The Cortex-M
+ * instructions have no host equivalent: barriers are compiler barriers,
+ * PRIMASK is a variable the simulator checks before taking an interrupt,
+ * __NOP and __WFI give it a chance to do so, and the bit operations are
+ * plain C. The rest of the CMSIS headers are used as they are.
+ */
+#ifndef __CMSIS_GCC_H
+#define __CMSIS_GCC_H
+
+#include <stdint.h>
+
+#ifndef __ASM
+#define __ASM                   __asm
+#endif
+#ifndef __INLINE
+#define __INLINE                inline
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE         static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE    __attribute__((always_inline)) static inline
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN             __attribute__((__noreturn__))
+#endif
+#ifndef __USED
+#define __USED                  __attribute__((used))
+#endif
+#ifndef __WEAK
+#define __WEAK                  __attribute__((weak))
+#endif
+#ifndef __PACKED
+#define __PACKED                __attribute__((packed, aligned(1)))
+#endif
+#ifndef __PACKED_STRUCT
+#define __PACKED_STRUCT         struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef __PACKED_UNION
+#define __PACKED_UNION          union __attribute__((packed, aligned(1)))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#endif
+#ifndef __RESTRICT
+#define __RESTRICT              __restrict
+#endif
+#ifndef __COMPILER_BARRIER
+#define __COMPILER_BARRIER()    __asm volatile("" ::: "memory")
+#endif
+
+struct __attribute__((packed)) T_UINT16 { uint16_t v; };
+struct __attribute__((packed)) T_UINT32 { uint32_t v; };
+
+#ifndef __UNALIGNED_UINT32
+#define __UNALIGNED_UINT32(x)           (((struct T_UINT32 *)(x))->v)
+#endif
+#ifndef __UNALIGNED_UINT16_WRITE
+#define __UNALIGNED_UINT16_WRITE(a, v)  ((((struct T_UINT16 *)(void *)(a))->v) = (v))
+#endif
+#ifndef __UNALIGNED_UINT16_READ
+#define __UNALIGNED_UINT16_READ(a)      (((const struct T_UINT16 *)(const void *)(a))->v)
+#endif
+#ifndef __UNALIGNED_UINT32_WRITE
+#define __UNALIGNED_UINT32_WRITE(a, v)  ((((struct T_UINT32 *)(void *)(a))->v) = (v))
+#endif
+#ifndef __UNALIGNED_UINT32_READ
+#define __UNALIGNED_UINT32_READ(a)      (((const struct T_UINT32 *)(const void *)(a))->v)
+#endif
+
+/* tools/regtrace/trace.c */
+extern volatile uint32_t rt_primask;
+void rt_nop(void);
+void rt_wfi(void);
+
+/* ---- core registers ---- */
+
+__STATIC_INLINE void __enable_irq(void)                 { rt_primask = 0; }
+__STATIC_INLINE void __disable_irq(void)                { rt_primask = 1; }
+__STATIC_INLINE uint32_t __get_PRIMASK(void)            { return rt_primask; }
+__STATIC_INLINE void __set_PRIMASK(uint32_t priMask)    { rt_primask = priMask & 1; }
+
+__STATIC_INLINE void __enable_fault_irq(void)           { }
+__STATIC_INLINE void __disable_fault_irq(void)          { }
+__STATIC_INLINE uint32_t __get_FAULTMASK(void)          { return 0; }
+__STATIC_INLINE void __set_FAULTMASK(uint32_t v)        { (void)v; }
+__STATIC_INLINE uint32_t __get_BASEPRI(void)            { return 0; }
+__STATIC_INLINE void __set_BASEPRI(uint32_t v)          { (void)v; }
+__STATIC_INLINE void __set_BASEPRI_MAX(uint32_t v)      { (void)v; }
+__STATIC_INLINE uint32_t __get_CONTROL(void)            { return 0; }
+__STATIC_INLINE void __set_CONTROL(uint32_t v)          { (void)v; }
+__STATIC_INLINE uint32_t __get_IPSR(void)               { return 0; }
+__STATIC_INLINE uint32_t __get_APSR(void)               { return 0; }
+__STATIC_INLINE uint32_t __get_xPSR(void)               { return 0x01000000; }
+__STATIC_INLINE uint32_t __get_PSP(void)                { return 0; }
+__STATIC_INLINE void __set_PSP(uint32_t v)              { (void)v; }
+__STATIC_INLINE uint32_t __get_MSP(void)                { return 0; }
+__STATIC_INLINE void __set_MSP(uint32_t v)              { (void)v; }
+__STATIC_INLINE uint32_t __get_FPSCR(void)              { return 0; }
+__STATIC_INLINE void __set_FPSCR(uint32_t v)            { (void)v; }
+
+/* ---- instructions ---- */
+
+#define __NOP()     rt_nop()
+#define __WFI()     rt_wfi()
+#define __WFE()     rt_wfi()
+#define __SEV()     ((void)0)
+#define __ISB()     __COMPILER_BARRIER()
+#define __DSB()     __COMPILER_BARRIER()
+#define __DMB()     __COMPILER_BARRIER()
+#define __BKPT(v)   __builtin_trap()
+#define __CLREX()   ((void)0)
+
+__STATIC_INLINE uint32_t __REV(uint32_t v)      { return __builtin_bswap32(v); }
+__STATIC_INLINE uint32_t __REV16(uint32_t v)    { return ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu); }
+__STATIC_INLINE int16_t __REVSH(int16_t v)      { return (int16_t)__builtin_bswap16((uint16_t)v); }
+
+__STATIC_INLINE uint32_t __ROR(uint32_t v, uint32_t n){
+    n %= 32;
+    return n == 0 ? v : (v >> n) | (v << (32 - n));
+}
+
+__STATIC_INLINE uint32_t __RBIT(uint32_t v){
+
+    uint32_t r = 0;
+    int i;
+
+    for(i = 0; i < 32; i++, v >>= 1)
+        r = (r << 1) | (v & 1);
+    return r;
+}
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t v)       { return v == 0 ? 32 : (uint8_t)__builtin_clz(v); }
+
+__STATIC_INLINE uint8_t __LDREXB(volatile uint8_t *p)               { return *p; }
+__STATIC_INLINE uint16_t __LDREXH(volatile uint16_t *p)             { return *p; }
+__STATIC_INLINE uint32_t __LDREXW(volatile uint32_t *p)             { return *p; }
+__STATIC_INLINE uint32_t __STREXB(uint8_t v, volatile uint8_t *p)   { *p = v; return 0; }
+__STATIC_INLINE uint32_t __STREXH(uint16_t v, volatile uint16_t *p) { *p = v; return 0; }
+__STATIC_INLINE uint32_t __STREXW(uint32_t v, volatile uint32_t *p) { *p = v; return 0; }
+
+__STATIC_INLINE int32_t __SSAT(int32_t v, uint32_t sat){
+
+    int32_t max = (int32_t)((1u << (sat - 1)) - 1), min = -max - 1;
+
+    return v > max ? max : v < min ? min : v;
+}
+
+__STATIC_INLINE uint32_t __USAT(int32_t v, uint32_t sat){
+
+    uint32_t max = (1u << sat) - 1;
+
+    return v < 0 ? 0 : (uint32_t)v > max ? max : (uint32_t)v;
+}
+
+__STATIC_INLINE uint32_t __RRX(uint32_t v)                      { return v >> 1; }
+__STATIC_INLINE uint8_t __LDRBT(volatile uint8_t *p)            { return *p; }
+__STATIC_INLINE uint16_t __LDRHT(volatile uint16_t *p)          { return *p; }
+__STATIC_INLINE uint32_t __LDRT(volatile uint32_t *p)           { return *p; }
+__STATIC_INLINE void __STRBT(uint8_t v, volatile uint8_t *p)    { *p = v; }
+__STATIC_INLINE void __STRHT(uint16_t v, volatile uint16_t *p)  { *p = v; }
+__STATIC_INLINE void __STRT(uint32_t v, volatile uint32_t *p)   { *p = v; }
+
+#endif /* __CMSIS_GCC_H */
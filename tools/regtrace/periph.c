@@ -0,0 +1,411 @@
+/*
+ * STM32L1 peripheral map, register names and the hardware model behind
+ * the traced registers. The model only does what the firmware waits for:
+ * clocks report ready once enabled, the system clock switch completes, the
+ * USART is always ready to send, memory to peripheral DMA transfers finish
+ * as soon as they start, SysTick's COUNTFLAG is set on every read. Every
+ * other register reads back what was last written.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "regtrace.h"
+
+static const char *const rcc_regs[] = {
+    "CR", "ICSCR", "CFGR", "CIR", "AHBRSTR", "APB2RSTR", "APB1RSTR", "AHBENR",
+    "APB2ENR", "APB1ENR", "AHBLPENR", "APB2LPENR", "APB1LPENR", "CSR"
+};
+static const char *const flash_regs[] = {
+    "ACR", "PECR", "PDKEYR", "PEKEYR", "PRGKEYR", "OPTKEYR", "SR", "OBR",
+    "WRPR1"
+};
+static const char *const pwr_regs[] = { "CR", "CSR" };
+static const char *const gpio_regs[] = {
+    "MODER", "OTYPER", "OSPEEDR", "PUPDR", "IDR", "ODR", "BSRR", "LCKR",
+    "AFRL", "AFRH", "BRR"
+};
+static const char *const usart_regs[] = { "SR", "DR", "BRR", "CR1", "CR2", "CR3", "GTPR" };
+static const char *const iwdg_regs[] = { "KR", "PR", "RLR", "SR" };
+static const char *const wwdg_regs[] = { "CR", "CFR", "SR" };
+static const char *const crc_regs[] = { "DR", "IDR", "CR" };
+static const char *const lcd_regs[] = {
+    "CR", "FCR", "SR", "CLR", "-", "RAM0", "RAM1", "RAM2", "RAM3", "RAM4",
+    "RAM5", "RAM6", "RAM7", "RAM8", "RAM9", "RAM10", "RAM11", "RAM12",
+    "RAM13", "RAM14", "RAM15"
+};
+static const char *const tim_regs[] = {
+    "CR1", "CR2", "SMCR", "DIER", "SR", "EGR", "CCMR1", "CCMR2", "CCER",
+    "CNT", "PSC", "ARR", "-", "CCR1", "CCR2", "CCR3", "CCR4", "-", "DCR",
+    "DMAR", "OR"
+};
+static const char *const syscfg_regs[] = {
+    "MEMRMP", "PMC", "EXTICR1", "EXTICR2", "EXTICR3", "EXTICR4"
+};
+static const char *const exti_regs[] = { "IMR", "EMR", "RTSR", "FTSR", "SWIER", "PR" };
+static const char *const systick_regs[] = { "CTRL", "LOAD", "VAL", "CALIB" };
+static const char *const scb_regs[] = {
+    "CPUID", "ICSR", "VTOR", "AIRCR", "SCR", "CCR", "SHP0", "SHP1", "SHP2",
+    "SHCSR", "CFSR", "HFSR", "DFSR", "MMFAR", "BFAR", "AFSR"
+};
+static const char *const coredebug_regs[] = { "DHCSR", "DCRSR", "DCRDR", "DEMCR" };
+static const char *const dwt_regs[] = {
+    "CTRL", "CYCCNT", "CPICNT", "EXCCNT", "SLEEPCNT", "LSUCNT", "FOLDCNT", "PCSR"
+};
+static const char *const dbgmcu_regs[] = { "IDCODE", "CR", "APB1FZ", "APB2FZ" };
+
+#define REGS(r) r, sizeof(r) / sizeof(r[0])
+
+/* Lookup goes in table order, so the system control block comes before
+   the NVIC range it sits in */
+static const struct rt_periph periphs[] = {
+    { "TIM2",      0x40000000u, 0x400, REGS(tim_regs) },
+    { "TIM3",      0x40000400u, 0x400, REGS(tim_regs) },
+    { "TIM4",      0x40000800u, 0x400, REGS(tim_regs) },
+    { "TIM5",      0x40000C00u, 0x400, REGS(tim_regs) },
+    { "TIM6",      0x40001000u, 0x400, REGS(tim_regs) },
+    { "TIM7",      0x40001400u, 0x400, REGS(tim_regs) },
+    { "LCD",       0x40002400u, 0x400, REGS(lcd_regs) },
+    { "RTC",       0x40002800u, 0x400, NULL, 0 },
+    { "WWDG",      0x40002C00u, 0x400, REGS(wwdg_regs) },
+    { "IWDG",      0x40003000u, 0x400, REGS(iwdg_regs) },
+    { "SPI2",      0x40003800u, 0x400, NULL, 0 },
+    { "SPI3",      0x40003C00u, 0x400, NULL, 0 },
+    { "USART2",    0x40004400u, 0x400, REGS(usart_regs) },
+    { "USART3",    0x40004800u, 0x400, REGS(usart_regs) },
+    { "UART4",     0x40004C00u, 0x400, REGS(usart_regs) },
+    { "UART5",     0x40005000u, 0x400, REGS(usart_regs) },
+    { "I2C1",      0x40005400u, 0x400, NULL, 0 },
+    { "I2C2",      0x40005800u, 0x400, NULL, 0 },
+    { "USB",       0x40005C00u, 0x400, NULL, 0 },
+    { "PWR",       0x40007000u, 0x400, REGS(pwr_regs) },
+    { "DAC",       0x40007400u, 0x400, NULL, 0 },
+    { "COMP",      0x40007C00u, 0x400, NULL, 0 },
+    { "SYSCFG",    0x40010000u, 0x400, REGS(syscfg_regs) },
+    { "EXTI",      0x40010400u, 0x400, REGS(exti_regs) },
+    { "TIM9",      0x40010800u, 0x400, REGS(tim_regs) },
+    { "TIM10",     0x40010C00u, 0x400, REGS(tim_regs) },
+    { "TIM11",     0x40011000u, 0x400, REGS(tim_regs) },
+    { "ADC1",      0x40012400u, 0x400, NULL, 0 },
+    { "SDIO",      0x40012C00u, 0x400, NULL, 0 },
+    { "SPI1",      0x40013000u, 0x400, NULL, 0 },
+    { "USART1",    0x40013800u, 0x400, REGS(usart_regs) },
+    { "GPIOA",     0x40020000u, 0x400, REGS(gpio_regs) },
+    { "GPIOB",     0x40020400u, 0x400, REGS(gpio_regs) },
+    { "GPIOC",     0x40020800u, 0x400, REGS(gpio_regs) },
+    { "GPIOD",     0x40020C00u, 0x400, REGS(gpio_regs) },
+    { "GPIOE",     0x40021000u, 0x400, REGS(gpio_regs) },
+    { "GPIOH",     0x40021400u, 0x400, REGS(gpio_regs) },
+    { "GPIOF",     0x40021800u, 0x400, REGS(gpio_regs) },
+    { "GPIOG",     0x40021C00u, 0x400, REGS(gpio_regs) },
+    { "CRC",       0x40023000u, 0x400, REGS(crc_regs) },
+    { "RCC",       0x40023800u, 0x400, REGS(rcc_regs) },
+    { "FLASH",     0x40023C00u, 0x400, REGS(flash_regs) },
+    { "DMA1",      0x40026000u, 0x400, NULL, 0 },
+    { "DMA2",      0x40026400u, 0x400, NULL, 0 },
+    { "DWT",       0xE0001000u, 0x1000, REGS(dwt_regs) },
+    { "SysTick",   0xE000E010u, 0x10, REGS(systick_regs) },
+    { "SCB",       0xE000ED00u, 0x40, REGS(scb_regs) },
+    { "CoreDebug", 0xE000EDF0u, 0x10, REGS(coredebug_regs) },
+    { "NVIC",      0xE000E100u, 0xE04, NULL, 0 },
+    { "DBGMCU",    0xE0042000u, 0x10, REGS(dbgmcu_regs) },
+};
+
+#define NPERIPHS ((int)(sizeof(periphs) / sizeof(periphs[0])))
+
+const struct rt_periph *rt_periph_find(uint32_t addr){
+
+    int i;
+
+    for(i = 0; i < NPERIPHS; i++)
+        if(addr - periphs[i].base < periphs[i].size)
+            return &periphs[i];
+
+    return NULL;
+}
+
+int rt_periph_index(const struct rt_periph *p){
+    return p == NULL ? NPERIPHS : (int)(p - periphs);
+}
+
+/* One more than the table, for accesses outside any known peripheral */
+int rt_periph_count(void){
+    return NPERIPHS + 1;
+}
+
+const struct rt_periph *rt_periph_get(int index){
+    return index < NPERIPHS ? &periphs[index] : NULL;
+}
+
+const char *rt_reg_name(uint32_t addr, char *buf, size_t len){
+
+    const struct rt_periph *p = rt_periph_find(addr);
+    uint32_t off, word;
+
+    if(p == NULL){
+        snprintf(buf, len, "0x%08x", (unsigned)addr);
+        return buf;
+    }
+
+    off = addr - p->base;
+    word = off / 4;
+    if(strncmp(p->name, "DMA", 3) == 0 && off >= 8){
+        /* channels of CCR, CNDTR, CPAR, CMAR and a reserved word */
+        static const char *const ch[] = { "CCR", "CNDTR", "CPAR", "CMAR", "-" };
+        snprintf(buf, len, "%s.%s%u", p->name, ch[(off - 8) / 4 % 5],
+                 (unsigned)((off - 8) / 20 + 1));
+    } else if(strcmp(p->name, "NVIC") == 0){
+        static const char *const banks[] = { "ISER", "ICER", "ISPR", "ICPR", "IABR" };
+        if(off < 0x280)
+            snprintf(buf, len, "NVIC.%s%u", banks[off / 0x80], (unsigned)(off % 0x80 / 4));
+        else if(off >= 0x300 && off < 0x3F0)
+            snprintf(buf, len, "NVIC.IP%u", (unsigned)(off - 0x300));
+        else
+            snprintf(buf, len, "NVIC+0x%03x", (unsigned)off);
+    } else if(word < p->nregs && strcmp(p->regs[word], "-") != 0){
+        snprintf(buf, len, "%s.%s", p->name, p->regs[word]);
+    } else {
+        snprintf(buf, len, "%s+0x%03x", p->name, (unsigned)off);
+    }
+
+    return buf;
+}
+
+uint32_t rt_reg_lookup(const char *name){
+
+    char buf[32];
+    const char *dot = strchr(name, '.');
+    uint32_t off;
+    int i;
+
+    if(dot == NULL)
+        return 0;
+    for(i = 0; i < NPERIPHS; i++){
+        if(strlen(periphs[i].name) != (size_t)(dot - name) ||
+           strncmp(periphs[i].name, name, dot - name) != 0)
+            continue;
+        for(off = 0; off < periphs[i].size; off += 4)
+            if(strcmp(rt_reg_name(periphs[i].base + off, buf, sizeof(buf)), name) == 0)
+                return periphs[i].base + off;
+    }
+
+    return 0;
+}
+
+/* ---- model ---- */
+
+#define REG(addr) (*(volatile uint32_t *)(uintptr_t)(addr))
+
+#define RCC_CR          0x40023800u
+#define RCC_ICSCR       0x40023804u
+#define RCC_CFGR        0x40023808u
+#define RCC_CSR         0x40023834u
+#define PWR_CR          0x40007000u
+#define PWR_CSR         0x40007004u
+#define FLASH_PECR      0x40023C04u
+#define FLASH_PEKEYR    0x40023C0Cu
+#define FLASH_PRGKEYR   0x40023C10u
+#define FLASH_SR        0x40023C18u
+#define GPIOA_MODER     0x40020000u
+#define GPIOA_PUPDR     0x4002000Cu
+#define GPIOB_MODER     0x40020400u
+#define GPIOB_OSPEEDR   0x40020408u
+#define GPIOB_PUPDR     0x4002040Cu
+#define IWDG_RLR        0x40003008u
+#define WWDG_CR         0x40002C00u
+#define WWDG_CFR        0x40002C04u
+#define LCD_CR          0x40002400u
+#define LCD_FCR         0x40002404u
+#define LCD_SR          0x40002408u
+#define LCD_CLR         0x4000240Cu
+#define CRC_DR          0x40023000u
+#define CRC_CR          0x40023008u
+#define SYSTICK_CTRL    0xE000E010u
+#define SYSTICK_VAL     0xE000E018u
+#define SCB_CPUID       0xE000ED00u
+#define SCB_AIRCR       0xE000ED0Cu
+#define SCB_CCR         0xE000ED14u
+#define DWT_CYCCNT      0xE0001004u
+#define DBGMCU_IDCODE   0xE0042000u
+
+#define USART_SR_READY  0xC0u           /* TXE | TC */
+#define FLASH_SR_READY  0x0Cu           /* READY | ENDHV */
+#define LCD_SR_ENS_RDY  0x11u
+#define LCD_SR_UDR      0x04u
+#define LCD_SR_UDD      0x08u
+#define LCD_SR_FCRSF    0x20u
+
+uint32_t rt_systick_ctrl;
+int rt_reset_request;
+
+static uint32_t flash_key;
+
+void rt_model_reset(void){
+
+    int i;
+
+    for(i = 0; i < NPERIPHS; i++)
+        memset((void *)(uintptr_t)periphs[i].base, 0, periphs[i].size);
+
+    REG(RCC_CR) = 0x00000300;           /* MSI on and ready */
+    REG(RCC_ICSCR) = 0x0000B000;
+    REG(RCC_CSR) = 0x0C000000;          /* power-on and pin reset */
+    REG(PWR_CR) = 0x00001000;           /* range 2 */
+    REG(PWR_CSR) = 0x00000008;
+    REG(FLASH_PECR) = 0x00000007;       /* locked */
+    REG(FLASH_SR) = FLASH_SR_READY;
+    REG(GPIOA_MODER) = 0xA8000000;      /* SWD pins */
+    REG(GPIOA_PUPDR) = 0x64000000;
+    REG(GPIOB_MODER) = 0x00000280;
+    REG(GPIOB_OSPEEDR) = 0x000000C0;
+    REG(GPIOB_PUPDR) = 0x00000100;
+    for(i = 0; i < NPERIPHS; i++)
+        if(periphs[i].regs == usart_regs)
+            REG(periphs[i].base) = USART_SR_READY;
+    REG(IWDG_RLR) = 0x00000FFF;
+    REG(WWDG_CR) = 0x0000007F;
+    REG(WWDG_CFR) = 0x0000007F;
+    REG(CRC_DR) = 0xFFFFFFFF;
+    REG(SCB_CPUID) = 0x412FC231;        /* Cortex-M3 r2p1 */
+    REG(SCB_AIRCR) = 0xFA050000;
+    REG(SCB_CCR) = 0x00000200;
+    REG(DBGMCU_IDCODE) = 0x10016437;
+
+    rt_systick_ctrl = 0;
+    rt_reset_request = 0;
+    flash_key = 0;
+}
+
+void rt_model_read(uint32_t addr){
+    switch(addr & ~3u){
+    case SYSTICK_CTRL:
+        /* every poll of LL_mDelay() sees a full period */
+        if(REG(SYSTICK_CTRL) & 1)
+            REG(SYSTICK_CTRL) |= 1u << 16;
+        break;
+    case DWT_CYCCNT:
+        REG(DWT_CYCCNT) += 1;
+        break;
+    }
+}
+
+static void dma_write(uint32_t base, uint32_t off, uint32_t value){
+
+    uint32_t ch, shift;
+
+    if(off == 4){
+        /* IFCR: write 1 to clear the ISR flags, reads as 0 */
+        REG(base) &= ~value;
+        REG(base + 4) = 0;
+        return;
+    }
+    if(off < 8 || (off - 8) % 20 != 0)
+        return;
+
+    /* CCRx: an enabled, non-circular memory to peripheral transfer
+       completes at once */
+    ch = (off - 8) / 20;
+    shift = 4 * ch;
+    if((value & 0x31u) == 0x11u){
+        REG(base + off + 4) = 0;
+        REG(base) |= 0x3u << shift;     /* GIF, TCIF */
+    }
+}
+
+static void crc_word(uint32_t value){
+
+    uint32_t crc = REG(CRC_DR) ^ value;
+    int b;
+
+    for(b = 0; b < 32; b++)
+        crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+    REG(CRC_DR) = crc;
+}
+
+void rt_model_write(uint32_t addr, uint32_t old){
+
+    const struct rt_periph *p;
+    uint32_t reg = addr & ~3u, v = REG(reg), off;
+
+    switch(reg){
+    case RCC_CR:
+        /* ready flags follow their enables: HSI, MSI, HSE, PLL */
+        v &= ~0x02020202u;
+        v |= (v & 0x01010101u) << 1;
+        REG(reg) = v;
+        return;
+    case RCC_CFGR:
+        REG(reg) = (v & ~0xCu) | ((v & 0x3u) << 2);     /* SWS = SW */
+        return;
+    case RCC_CSR:
+        v &= ~0x202u;
+        v |= (v & 0x101u) << 1;                         /* LSI, LSE ready */
+        if(v & (1u << 24))                              /* RMVF */
+            v &= 0x00FFFFFFu;
+        REG(reg) = v;
+        return;
+    case FLASH_PEKEYR:
+    case FLASH_PRGKEYR:
+        if((reg == FLASH_PEKEYR && flash_key == 0x89ABCDEF && v == 0x02030405) ||
+           (reg == FLASH_PRGKEYR && flash_key == 0x8C9DAEBF && v == 0x13141516))
+            REG(FLASH_PECR) &= reg == FLASH_PEKEYR ? ~1u : ~2u;
+        flash_key = v;
+        REG(reg) = 0;
+        return;
+    case FLASH_SR:
+        REG(reg) = FLASH_SR_READY;
+        return;
+    case LCD_CR:
+        REG(LCD_SR) = (v & 1) ? REG(LCD_SR) | LCD_SR_ENS_RDY : REG(LCD_SR) & ~LCD_SR_ENS_RDY;
+        return;
+    case LCD_FCR:
+        REG(LCD_SR) |= LCD_SR_FCRSF;
+        return;
+    case LCD_SR:
+        /* only UDR is writable; the update is latched at once */
+        REG(reg) = (v & LCD_SR_UDR) ? (old & ~LCD_SR_UDR) | LCD_SR_UDD : old;
+        return;
+    case LCD_CLR:
+        REG(LCD_SR) &= ~(v & 0x0Au);                    /* SOFC, UDDC */
+        REG(reg) = 0;
+        return;
+    case CRC_DR:
+        REG(reg) = old;
+        crc_word(v);
+        return;
+    case CRC_CR:
+        if(v & 1)
+            REG(CRC_DR) = 0xFFFFFFFF;
+        REG(reg) = v & ~1u;
+        return;
+    case SYSTICK_CTRL:
+        rt_systick_ctrl = v;
+        return;
+    case SYSTICK_VAL:
+        REG(reg) = 0;
+        return;
+    case SCB_AIRCR:
+        if((v >> 16) == 0x05FA && (v & 4))
+            rt_reset_request = 1;
+        REG(reg) = 0xFA050000 | (v & 0x700);
+        return;
+    }
+
+    p = rt_periph_find(reg);
+    if(p == NULL)
+        return;
+    off = reg - p->base;
+
+    if(p->regs == usart_regs && off == 0)
+        REG(reg) = v | USART_SR_READY;
+    else if(p->regs == gpio_regs && off == 0x18){
+        /* BSRR: set low half, reset high half, reads as 0 */
+        REG(p->base + 0x14) = (REG(p->base + 0x14) | (v & 0xFFFF)) & ~(v >> 16);
+        REG(reg) = 0;
+    } else if(p->regs == gpio_regs && off == 0x28){
+        REG(p->base + 0x14) &= ~(v & 0xFFFF);
+        REG(reg) = 0;
+    } else if(p->regs == iwdg_regs && off == 0)
+        REG(reg) = 0;                               /* KR is write-only */
+    else if(strncmp(p->name, "DMA", 3) == 0)
+        dma_write(p->base, off, v);
+}
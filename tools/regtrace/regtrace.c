@@ -0,0 +1,112 @@
+/*
+ * Register access tracer: runs the reset path and the main loop of the
+ * firmware on the host and reports every peripheral register access.
+ *
+ *   regtrace [-t ms] [-l log] [-a allow.txt] [-w baseline] [-c baseline]
+ *
+ *   -t ms        simulated run time of main(), default 1000
+ *   -l file      log every access in order: function, register, R or W,
+ *                value
+ *   -a file      back-to-back read-modify-writes that are expected
+ *   -w file      write the per-function access counts as the baseline
+ *   -c file      compare against the baseline: exit 1 if a function makes
+ *                more accesses per call than it used to, or if a new
+ *                read-modify-write merge opportunity shows up
+ *
+ * The firmware runs like after a power-on reset: SystemInit(), then main()
+ * until the time is up. Time is counted in SysTick periods, which the
+ * simulator advances every RT_ACCESSES_PER_TICK accesses and calls.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "regtrace.h"
+
+/* The firmware, built with -Dmain=firmware_main */
+extern void SystemInit(void);
+extern int firmware_main(void);
+
+/* Startup code, as in startup_stm32l152xe.s */
+static void reset(void){
+    SystemInit();
+    firmware_main();
+}
+
+int main(int argc, char **argv){
+
+    const char *allow = NULL, *baseline_out = NULL, *baseline_in = NULL, *access_log = NULL;
+    const struct rt_finding *findings;
+    uint32_t ms = 1000, addr;
+    size_t n, i;
+    int opt, status, bad = 0;
+    char name[32];
+
+    while((opt = getopt(argc, argv, "t:l:a:w:c:")) != -1){
+        switch(opt){
+        case 't': ms = (uint32_t)atoi(optarg); break;
+        case 'l': access_log = optarg; break;
+        case 'a': allow = optarg; break;
+        case 'w': baseline_out = optarg; break;
+        case 'c': baseline_in = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-t ms] [-l log] [-a allow] [-w baseline] [-c baseline]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    if(rt_symbols_load() < 0 || rt_trap_init() < 0)
+        return 2;
+    if(allow != NULL && rt_allow_load(allow) < 0)
+        return 2;
+    if(access_log != NULL && (rt_access_log = fopen(access_log, "w")) == NULL){
+        perror(access_log);
+        return 2;
+    }
+
+    /* the firmware runs forever: stop it on time, and give up if it keeps
+       polling a register the model never changes */
+    status = rt_run(reset, ms, (uint64_t)(ms + 100) * RT_ACCESSES_PER_TICK * 4);
+    if(status < 0){
+        const char *func = rt_stuck(&addr);
+
+        fprintf(stderr, "regtrace: no progress in %s, last access %s\n", func,
+                rt_reg_name(addr, name, sizeof(name)));
+        return 2;
+    }
+    if(status > 0)
+        printf("firmware requested a system reset\n");
+    if(rt_access_log != NULL && fclose(rt_access_log) != 0){
+        perror(access_log);
+        return 2;
+    }
+    rt_access_log = NULL;
+
+    rt_report(stdout);
+
+    n = rt_findings(&findings);
+    for(i = 0; i < n; i++)
+        if(!rt_allowed(&findings[i]))
+            bad++;
+
+    if(baseline_out != NULL && rt_baseline_write(baseline_out) < 0)
+        return 2;
+    if(baseline_in != NULL){
+        int worse;
+
+        printf("\nchanges against %s:\n", baseline_in);
+        worse = rt_baseline_check(baseline_in, stdout);
+        if(worse < 0)
+            return 2;
+        if(worse > 0 || bad > 0){
+            printf("FAIL: %d function(s) gained register accesses, "
+                   "%d read-modify-write(s) to merge\n", worse, bad);
+            return 1;
+        }
+        printf("OK\n");
+    }
+
+    return 0;
+}
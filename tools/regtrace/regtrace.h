@@ -0,0 +1,145 @@
+/*
+ * Host-side register access tracer for the firmware.
+ *
+ * The firmware sources and the LL drivers are compiled for the host,
+ * unmodified, with -finstrument-functions, and run against peripheral
+ * memory mapped at the real STM32L1 addresses. Those pages are kept
+ * inaccessible: every load or store to a register faults, the handler lets
+ * the instruction through with a single step, records the access against
+ * the function that made it, and applies a small model of the hardware so
+ * that ready flags and the like read back as the code expects.
+ */
+#ifndef REGTRACE_H
+#define REGTRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ---- peripherals and hardware model (periph.c) ---- */
+
+struct rt_periph {
+    const char *name;
+    uint32_t base;
+    uint32_t size;
+    const char *const *regs;    /* register names by word offset, or NULL */
+    uint32_t nregs;
+};
+
+/* Peripheral containing addr, or NULL */
+const struct rt_periph *rt_periph_find(uint32_t addr);
+
+/* Index of p in the peripheral table, for per-peripheral counters */
+int rt_periph_index(const struct rt_periph *p);
+int rt_periph_count(void);
+const struct rt_periph *rt_periph_get(int index);
+
+/* "RCC.CR", "DMA1.CNDTR5", or the address if unknown */
+const char *rt_reg_name(uint32_t addr, char *buf, size_t len);
+
+/* Register address from its name, 0 if unknown */
+uint32_t rt_reg_lookup(const char *name);
+
+/* Load the reset values. Peripheral memory must be writable. */
+void rt_model_reset(void);
+
+/* Called with peripheral memory writable, before a read executes and
+   after a write has been done (old is the previous content) */
+void rt_model_read(uint32_t addr);
+void rt_model_write(uint32_t addr, uint32_t old);
+
+/* Hardware state the simulator needs outside the trap handler */
+extern uint32_t rt_systick_ctrl;
+extern int rt_reset_request;
+
+/* ---- address space (trap.c) ---- */
+
+/* Map the peripheral and memory regions and install the fault handlers.
+   Returns 0, or -1 with a message printed. */
+int rt_trap_init(void);
+
+/* Stop trapping / trap again, e.g. to load reset values */
+void rt_trap_open(void);
+void rt_trap_close(void);
+
+/* ---- accounting (trace.c) ---- */
+
+#define RT_MAX_DEPTH 64
+
+struct rt_func {
+    void *fn;
+    const char *name;
+    uint32_t calls;
+    uint32_t open;              /* calls still active when the run stopped */
+    uint64_t self;              /* accesses made by the function itself */
+    uint64_t total;             /* including callees, not interrupts */
+    uint32_t max;               /* largest total of a single call */
+};
+
+struct rt_reg {
+    uint32_t addr;
+    uint64_t reads, writes, rmw;
+};
+
+/* Back-to-back read-modify-writes of one register: write R, then read R
+   and write R again with nothing in between. The two writes could be one. */
+struct rt_finding {
+    const struct rt_func *site;     /* innermost function calling both */
+    uint32_t addr;
+    uint32_t count;
+};
+
+struct rt_totals {
+    uint64_t accesses, reads, writes, rmw;
+    uint64_t irq_accesses;
+    uint32_t ticks;                 /* SysTick interrupts delivered */
+};
+
+/* Resolve function names from the executable's symbol table */
+int rt_symbols_load(void);
+
+/* Record one access; called from the trap handler. value is what was
+   read, or what the firmware wrote before the model reacted to it. */
+void rt_record(uint32_t addr, int write, uint32_t value);
+
+/* If set, every access is also logged there in order:
+   "function PERIPH.REG R|W value", with " irq" for interrupt context */
+extern FILE *rt_access_log;
+
+/* Run fn until it returns, the simulated time reaches ticks (SysTick
+   periods), it requests a system reset, or it has made max_work register
+   accesses and calls. Returns 0 if it returned or ran out of time, 1 on
+   reset, -1 if stuck. */
+int rt_run(void (*fn)(void), uint32_t ticks, uint64_t max_work);
+
+/* After rt_run() returned -1: the function that was running and the
+   register it accessed last, usually a flag the model never sets */
+const char *rt_stuck(uint32_t *addr);
+
+/* Results */
+const struct rt_totals *rt_totals(void);
+size_t rt_funcs(const struct rt_func **out);
+size_t rt_regs(const struct rt_reg **out);
+size_t rt_findings(const struct rt_finding **out);
+const uint64_t *rt_periph_counts(int index);  /* reads, writes, rmw */
+
+/* SysTick period in register accesses and function calls: the simulator
+   has no clock, time advances with the work done while the SysTick counter
+   is enabled */
+#define RT_ACCESSES_PER_TICK 100
+
+/* ---- report (report.c) ---- */
+
+/* Allowed findings, one "function PERIPH.REG" per line, # comments */
+int rt_allow_load(const char *path);
+int rt_allowed(const struct rt_finding *f);
+
+void rt_report(FILE *out);
+
+/* Baseline: the largest per-call access count of every function. Check
+   prints the functions that got worse and returns how many did, or -1 if
+   the file cannot be read. */
+int rt_baseline_write(const char *path);
+int rt_baseline_check(const char *path, FILE *out);
+
+#endif /* REGTRACE_H */
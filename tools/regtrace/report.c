@@ -0,0 +1,222 @@
+/*
+ * Text report, allowed findings and the baseline check.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regtrace.h"
+
+struct allow {
+    char func[64];
+    uint32_t addr;
+};
+
+static struct allow allows[64];
+static size_t n_allows;
+
+int rt_allow_load(const char *path){
+
+    char line[256], func[64], reg[32];
+    FILE *f = fopen(path, "r");
+
+    if(f == NULL){
+        perror(path);
+        return -1;
+    }
+    while(fgets(line, sizeof(line), f) != NULL){
+        if(line[0] == '#' || sscanf(line, "%63s %31s", func, reg) != 2)
+            continue;
+        if(n_allows == sizeof(allows) / sizeof(allows[0]))
+            break;
+        strcpy(allows[n_allows].func, func);
+        allows[n_allows].addr = rt_reg_lookup(reg);
+        if(allows[n_allows].addr == 0)
+            fprintf(stderr, "%s: unknown register %s\n", path, reg);
+        else
+            n_allows++;
+    }
+    fclose(f);
+
+    return 0;
+}
+
+int rt_allowed(const struct rt_finding *f){
+
+    size_t i;
+
+    for(i = 0; i < n_allows; i++)
+        if(f->addr == allows[i].addr && f->site != NULL &&
+           strcmp(f->site->name, allows[i].func) == 0)
+            return 1;
+
+    return 0;
+}
+
+static int func_cmp(const void *a, const void *b){
+
+    const struct rt_func *x = a, *y = b;
+
+    return strcmp(x->name, y->name);
+}
+
+static int reg_cmp(const void *a, const void *b){
+
+    const struct rt_reg *x = a, *y = b;
+
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+/* Sorted copy of the functions, only those that made register accesses
+   if accessed is set. A static inline function has a copy in every
+   translation unit that calls it: the copies are merged into one entry per
+   name, with the largest per-call count. */
+static size_t sorted_funcs(struct rt_func **out, int accessed){
+
+    const struct rt_func *funcs;
+    size_t n = rt_funcs(&funcs), i, k = 0;
+    struct rt_func *f;
+
+    *out = malloc((n ? n : 1) * sizeof(**out));
+    for(i = 0; i < n; i++)
+        if(!accessed || funcs[i].total > 0)
+            (*out)[k++] = funcs[i];
+    qsort(*out, k, sizeof(**out), func_cmp);
+
+    for(i = 0, n = 0; i < k; i++){
+        f = &(*out)[i];
+        if(n > 0 && strcmp((*out)[n - 1].name, f->name) == 0){
+            struct rt_func *m = &(*out)[n - 1];
+
+            m->calls += f->calls;
+            m->open += f->open;
+            m->self += f->self;
+            m->total += f->total;
+            if(f->max > m->max)
+                m->max = f->max;
+        } else {
+            (*out)[n++] = *f;
+        }
+    }
+
+    return n;
+}
+
+void rt_report(FILE *out){
+
+    const struct rt_totals *t = rt_totals();
+    const struct rt_finding *findings;
+    const struct rt_reg *regs;
+    struct rt_func *funcs;
+    struct rt_reg *sorted;
+    size_t n, i;
+    char name[32];
+    int p;
+
+    fprintf(out, "%llu register accesses: %llu reads, %llu writes, %llu read-modify-writes\n",
+            (unsigned long long)t->accesses, (unsigned long long)t->reads,
+            (unsigned long long)t->writes, (unsigned long long)t->rmw);
+    fprintf(out, "%u SysTick interrupts, %llu accesses in the handler\n\n",
+            (unsigned)t->ticks, (unsigned long long)t->irq_accesses);
+
+    fprintf(out, "%-10s %10s %10s %10s\n", "peripheral", "reads", "writes", "rmw");
+    for(p = 0; p < rt_periph_count(); p++){
+        const uint64_t *c = rt_periph_counts(p);
+        const struct rt_periph *per = rt_periph_get(p);
+
+        if(c[0] + c[1] > 0)
+            fprintf(out, "%-10s %10llu %10llu %10llu\n", per ? per->name : "other",
+                    (unsigned long long)c[0], (unsigned long long)c[1],
+                    (unsigned long long)c[2]);
+    }
+
+    n = rt_regs(&regs);
+    sorted = malloc((n ? n : 1) * sizeof(*sorted));
+    memcpy(sorted, regs, n * sizeof(*sorted));
+    qsort(sorted, n, sizeof(*sorted), reg_cmp);
+    fprintf(out, "\n%-18s %10s %10s %10s\n", "register", "reads", "writes", "rmw");
+    for(i = 0; i < n; i++)
+        fprintf(out, "%-18s %10llu %10llu %10llu\n",
+                rt_reg_name(sorted[i].addr, name, sizeof(name)),
+                (unsigned long long)sorted[i].reads, (unsigned long long)sorted[i].writes,
+                (unsigned long long)sorted[i].rmw);
+    free(sorted);
+
+    n = sorted_funcs(&funcs, 1);
+    fprintf(out, "\n%-36s %8s %8s %10s %10s\n", "function", "calls", "max/call",
+            "total", "self");
+    for(i = 0; i < n; i++)
+        fprintf(out, "%-36s %8u %8u %10llu %10llu%s\n", funcs[i].name,
+                (unsigned)funcs[i].calls, (unsigned)funcs[i].max,
+                (unsigned long long)funcs[i].total, (unsigned long long)funcs[i].self,
+                funcs[i].open ? "  (cut short)" : "");
+    free(funcs);
+
+    n = rt_findings(&findings);
+    fprintf(out, "\nback-to-back read-modify-writes (the writes can be merged):\n");
+    for(i = 0; i < n; i++)
+        fprintf(out, "  %-34s %-18s %6ux%s\n",
+                findings[i].site ? findings[i].site->name : "?",
+                rt_reg_name(findings[i].addr, name, sizeof(name)),
+                (unsigned)findings[i].count, rt_allowed(&findings[i]) ? "  (allowed)" : "");
+    if(n == 0)
+        fprintf(out, "  none\n");
+}
+
+/* One "function max-per-call" line per function, sorted, so the file
+   diffs well under version control */
+int rt_baseline_write(const char *path){
+
+    struct rt_func *funcs;
+    size_t n = sorted_funcs(&funcs, 1), i;
+    FILE *f = fopen(path, "w");
+
+    if(f == NULL){
+        perror(path);
+        free(funcs);
+        return -1;
+    }
+    fprintf(f, "# register accesses per call, written by tools/regtrace -w\n");
+    for(i = 0; i < n; i++)
+        fprintf(f, "%s %u\n", funcs[i].name, (unsigned)funcs[i].max);
+    free(funcs);
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int rt_baseline_check(const char *path, FILE *out){
+
+    char line[512], name[400];
+    struct rt_func *funcs;
+    size_t n, i;
+    unsigned max;
+    int worse = 0;
+    FILE *f = fopen(path, "r");
+
+    if(f == NULL){
+        perror(path);
+        return -1;
+    }
+    n = sorted_funcs(&funcs, 0);
+    while(fgets(line, sizeof(line), f) != NULL){
+        if(line[0] == '#' || sscanf(line, "%399s %u", name, &max) != 2)
+            continue;
+        for(i = 0; i < n; i++)
+            if(strcmp(funcs[i].name, name) == 0)
+                break;
+        if(i == n){
+            fprintf(out, "  %-36s gone (was %u)\n", name, max);
+        } else if(funcs[i].max > max){
+            fprintf(out, "  %-36s %u -> %u accesses per call\n", name, max,
+                    (unsigned)funcs[i].max);
+            worse++;
+        } else if(funcs[i].max < max){
+            fprintf(out, "  %-36s %u -> %u accesses per call, update the baseline\n",
+                    name, max, (unsigned)funcs[i].max);
+        }
+    }
+    free(funcs);
+    fclose(f);
+
+    return worse;
+}
@@ -0,0 +1,415 @@
+/*
+ * Access accounting: the call stack kept by the -finstrument-functions
+ * hooks, counters per function, peripheral and register, detection of
+ * mergeable read-modify-writes, and the simulated SysTick interrupt.
+ */
+#define _GNU_SOURCE
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "regtrace.h"
+
+#define NOINSTR __attribute__((no_instrument_function))
+
+/* ---- symbols ---- */
+
+struct symbol {
+    uintptr_t addr;
+    const char *name;
+};
+
+static struct symbol *symbols;
+static size_t n_symbols;
+
+static int symbol_cmp(const void *a, const void *b){
+
+    const struct symbol *x = a, *y = b;
+
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+/* The executable is linked with -no-pie, so nm addresses are the runtime
+   ones and static functions (the LL inlines) are found too */
+int rt_symbols_load(void){
+
+    const char *nm = getenv("NM") ? getenv("NM") : "nm";
+    char cmd[256], line[512], type, name[400];
+    unsigned long addr;
+    size_t room = 0;
+    FILE *p;
+
+    snprintf(cmd, sizeof(cmd), "%s --defined-only /proc/%d/exe", nm, (int)getpid());
+    p = popen(cmd, "r");
+    if(p == NULL)
+        return -1;
+    while(fgets(line, sizeof(line), p) != NULL){
+        if(sscanf(line, "%lx %c %399s", &addr, &type, name) != 3 ||
+           (type != 't' && type != 'T' && type != 'W' && type != 'w'))
+            continue;
+        if(n_symbols == room){
+            room = room ? room * 2 : 1024;
+            symbols = realloc(symbols, room * sizeof(*symbols));
+        }
+        symbols[n_symbols].addr = addr;
+        symbols[n_symbols].name = strdup(name);
+        n_symbols++;
+    }
+    if(pclose(p) != 0 || n_symbols == 0){
+        fprintf(stderr, "regtrace: no symbols from %s\n", nm);
+        return -1;
+    }
+    qsort(symbols, n_symbols, sizeof(*symbols), symbol_cmp);
+
+    return 0;
+}
+
+static const char *symbol_name(void *fn){
+
+    struct symbol key = { (uintptr_t)fn, NULL }, *s;
+    char buf[32];
+
+    s = bsearch(&key, symbols, n_symbols, sizeof(*symbols), symbol_cmp);
+    if(s != NULL)
+        return s->name;
+
+    snprintf(buf, sizeof(buf), "%p", fn);
+    return strdup(buf);
+}
+
+/* ---- functions ---- */
+
+#define FUNC_HASH 4096
+
+static struct rt_func funcs[FUNC_HASH / 2];
+static size_t n_funcs;
+static struct rt_func *func_index[FUNC_HASH];
+
+static struct rt_func *func_get(void *fn){
+
+    size_t h = ((uintptr_t)fn >> 4) & (FUNC_HASH - 1);
+    struct rt_func *f;
+
+    while((f = func_index[h]) != NULL){
+        if(f->fn == fn)
+            return f;
+        h = (h + 1) & (FUNC_HASH - 1);
+    }
+    if(n_funcs == sizeof(funcs) / sizeof(funcs[0])){
+        fprintf(stderr, "regtrace: too many functions\n");
+        abort();
+    }
+    f = &funcs[n_funcs++];
+    f->fn = fn;
+    f->name = symbol_name(fn);
+    func_index[h] = f;
+
+    return f;
+}
+
+/* ---- registers and peripherals ---- */
+
+#define REG_HASH 1024
+
+static struct rt_reg regs[REG_HASH / 2];
+static size_t n_regs;
+static struct rt_reg *reg_index[REG_HASH];
+static uint64_t *periph_counts;
+
+static struct rt_reg *reg_get(uint32_t addr){
+
+    size_t h = (addr >> 2) & (REG_HASH - 1);
+    struct rt_reg *r;
+
+    while((r = reg_index[h]) != NULL){
+        if(r->addr == addr)
+            return r;
+        h = (h + 1) & (REG_HASH - 1);
+    }
+    if(n_regs == sizeof(regs) / sizeof(regs[0]))
+        abort();
+    r = &regs[n_regs++];
+    r->addr = addr;
+    reg_index[h] = r;
+
+    return r;
+}
+
+/* ---- call stack ---- */
+
+struct frame {
+    struct rt_func *func;
+    uint32_t serial;
+    uint64_t at_entry;          /* access counters when entered */
+    uint64_t irq_at_entry;
+};
+
+static struct frame stack[RT_MAX_DEPTH];
+static int depth;
+static uint32_t serials;
+
+/* Accesses of each context: thread mode, SysTick handler. Each remembers
+   the last two accesses and the call stack at the time, by frame serial. */
+struct access {
+    uint32_t addr;
+    int write;
+    int depth;
+    uint32_t serial[RT_MAX_DEPTH];
+};
+
+struct context {
+    struct access last[2];      /* [0] most recent */
+    int n;
+};
+
+static struct context contexts[2];
+static int in_irq;
+
+static struct rt_finding findings[256];
+static size_t n_findings;
+static struct rt_totals totals;
+
+volatile uint32_t rt_primask;
+static int tick_pending;
+static uint32_t since_tick;
+static uint32_t tick_limit;
+static uint64_t work, work_limit;
+static jmp_buf run_jmp;
+static int running;
+static uint32_t stuck_addr;
+static const char *stuck_func;
+
+FILE *rt_access_log;
+
+extern void SysTick_Handler(void);
+
+static void add_finding(const struct rt_func *site, uint32_t addr){
+
+    size_t i;
+
+    for(i = 0; i < n_findings; i++)
+        if(findings[i].site == site && findings[i].addr == addr){
+            findings[i].count++;
+            return;
+        }
+    if(n_findings < sizeof(findings) / sizeof(findings[0])){
+        findings[n_findings].site = site;
+        findings[n_findings].addr = addr;
+        findings[n_findings].count = 1;
+        n_findings++;
+    }
+}
+
+/* Innermost frame still active from the older access to now */
+static const struct rt_func *common_caller(const struct access *a){
+
+    int i, n = a->depth < depth ? a->depth : depth;
+
+    for(i = 0; i < n && a->serial[i] == stack[i].serial; i++)
+        ;
+    return i > 0 ? stack[i - 1].func : NULL;
+}
+
+/* Simulated time: the SysTick counter runs with the work done, register
+   accesses and function calls */
+static void advance(void){
+
+    if((rt_systick_ctrl & 3) == 3 && ++since_tick >= RT_ACCESSES_PER_TICK){
+        since_tick = 0;
+        tick_pending = 1;
+    }
+    if(running && ++work > work_limit)
+        longjmp(run_jmp, 3);
+}
+
+void rt_record(uint32_t addr, int write, uint32_t value){
+
+    struct context *c = &contexts[in_irq];
+    const struct rt_periph *p;
+    uint64_t *pc;
+    struct rt_reg *r;
+    int i, rmw;
+    char name[32];
+
+    addr &= ~3u;
+    if(rt_access_log != NULL)
+        fprintf(rt_access_log, "%s %s %c 0x%08x%s\n",
+                depth > 0 ? stack[depth - 1].func->name : "-",
+                rt_reg_name(addr, name, sizeof(name)), write ? 'W' : 'R',
+                (unsigned)value, in_irq ? " irq" : "");
+    r = reg_get(addr);
+    p = rt_periph_find(addr);
+    pc = &periph_counts[3 * rt_periph_index(p)];
+
+    /* a write right after a read of the same register */
+    rmw = write && c->n > 0 && !c->last[0].write && c->last[0].addr == addr;
+
+    totals.accesses++;
+    if(in_irq)
+        totals.irq_accesses++;
+    if(write){
+        totals.writes++;
+        r->writes++;
+        pc[1]++;
+    } else {
+        totals.reads++;
+        r->reads++;
+        pc[0]++;
+    }
+    if(rmw){
+        totals.rmw++;
+        r->rmw++;
+        pc[2]++;
+        /* ... and the read came right after a write of it */
+        if(c->n > 1 && c->last[1].write && c->last[1].addr == addr)
+            add_finding(common_caller(&c->last[1]), addr);
+    }
+    if(depth > 0)
+        stack[depth - 1].func->self++;
+
+    c->last[1] = c->last[0];
+    c->last[0].addr = addr;
+    c->last[0].write = write;
+    c->last[0].depth = depth;
+    for(i = 0; i < depth; i++)
+        c->last[0].serial[i] = stack[i].serial;
+    if(c->n < 2)
+        c->n++;
+
+    advance();
+}
+
+/* Take a pending SysTick at a function boundary, as if the interrupt had
+   arrived there; its accesses are not charged to the interrupted calls */
+static void irq_poll(void){
+
+    if(!running)
+        return;
+    if(!in_irq && (rt_reset_request || totals.ticks >= tick_limit))
+        longjmp(run_jmp, rt_reset_request ? 2 : 1);
+    if(in_irq || !tick_pending || rt_primask)
+        return;
+
+    tick_pending = 0;
+    totals.ticks++;
+    in_irq = 1;
+    SysTick_Handler();
+    in_irq = 0;
+}
+
+NOINSTR void __cyg_profile_func_enter(void *fn, void *site){
+
+    struct frame *f;
+
+    (void)site;
+    advance();
+    irq_poll();
+    if(depth == RT_MAX_DEPTH){
+        fprintf(stderr, "regtrace: call stack too deep\n");
+        abort();
+    }
+    f = &stack[depth++];
+    f->func = func_get(fn);
+    f->serial = ++serials;
+    f->at_entry = totals.accesses;
+    f->irq_at_entry = totals.irq_accesses;
+}
+
+static void frame_close(struct frame *f, int open){
+
+    uint64_t n = totals.accesses - f->at_entry;
+
+    if(!in_irq)
+        n -= totals.irq_accesses - f->irq_at_entry;
+    f->func->calls++;
+    f->func->open += open;
+    f->func->total += n;
+    if(n > f->func->max)
+        f->func->max = (uint32_t)n;
+}
+
+NOINSTR void __cyg_profile_func_exit(void *fn, void *site){
+
+    (void)fn;
+    (void)site;
+    if(depth > 0)
+        frame_close(&stack[--depth], 0);
+}
+
+/* The CMSIS stand-ins, see host/cmsis_gcc.h */
+NOINSTR void rt_nop(void){
+    irq_poll();
+}
+
+NOINSTR void rt_wfi(void){
+    if((rt_systick_ctrl & 3) == 3)
+        tick_pending = 1;
+    irq_poll();
+}
+
+int rt_run(void (*fn)(void), uint32_t ticks, uint64_t max_work){
+
+    volatile int status;
+
+    if(periph_counts == NULL)
+        periph_counts = calloc(3 * rt_periph_count(), sizeof(*periph_counts));
+
+    rt_trap_open();
+    rt_model_reset();
+    rt_trap_close();
+    memset(contexts, 0, sizeof(contexts));
+    rt_primask = 0;
+    tick_pending = 0;
+    since_tick = 0;
+    in_irq = 0;
+    tick_limit = totals.ticks + ticks;
+    work = 0;
+    work_limit = max_work;
+
+    running = 1;
+    status = setjmp(run_jmp);
+    if(status == 0)
+        fn();
+    running = 0;
+    if(status == 3){
+        stuck_addr = contexts[in_irq].last[0].addr;
+        stuck_func = depth > 0 ? stack[depth - 1].func->name : "?";
+    }
+    in_irq = 0;
+
+    /* the calls cut short still count, as far as they got */
+    while(depth > 0)
+        frame_close(&stack[--depth], 1);
+
+    return status == 3 ? -1 : status == 2;
+}
+
+const char *rt_stuck(uint32_t *addr){
+    *addr = stuck_addr;
+    return stuck_func;
+}
+
+const struct rt_totals *rt_totals(void){
+    return &totals;
+}
+
+size_t rt_funcs(const struct rt_func **out){
+    *out = funcs;
+    return n_funcs;
+}
+
+size_t rt_regs(const struct rt_reg **out){
+    *out = regs;
+    return n_regs;
+}
+
+size_t rt_findings(const struct rt_finding **out){
+    *out = findings;
+    return n_findings;
+}
+
+const uint64_t *rt_periph_counts(int index){
+    return &periph_counts[3 * index];
+}
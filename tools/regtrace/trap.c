@@ -0,0 +1,158 @@
+/*
+ * Address space of the simulated MCU and the access traps (x86-64 Linux).
+ *
+ * Peripheral regions are mapped at their real addresses with no access
+ * rights. A load or store faults with SIGSEGV; the handler opens the
+ * regions, runs the model for a read, and sets the trap flag so that the
+ * instruction executes alone. The SIGTRAP that follows records the access,
+ * runs the model for a write and closes the regions again. GCC never folds
+ * a volatile access into a read-modify-write instruction, so a C "|=" is
+ * seen as a read and a write, like on the Cortex-M3.
+ */
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "regtrace.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE MAP_FIXED
+#endif
+
+struct region {
+    uint32_t base;
+    uint32_t size;
+    int traced;
+};
+
+static const struct region regions[] = {
+    { 0x08000000u, 0x00080000u, 0 },    /* flash */
+    { 0x08080000u, 0x00004000u, 0 },    /* data EEPROM */
+    { 0x1FF80000u, 0x00001000u, 0 },    /* option bytes, device id */
+    { 0x40000000u, 0x00028000u, 1 },    /* APB1, APB2, AHB */
+    { 0xE0000000u, 0x00100000u, 1 },    /* private peripheral bus */
+};
+
+#define NREGIONS (sizeof(regions) / sizeof(regions[0]))
+
+#define EFLAGS_TF 0x100
+
+/* the access being single stepped */
+static const struct region *pending_region;
+static uint32_t pending_addr;
+static uint32_t pending_old;
+static int pending_write;
+static int pending;
+
+static const struct region *find_region(uintptr_t addr){
+
+    size_t i;
+
+    for(i = 0; i < NREGIONS; i++)
+        if(regions[i].traced && addr - regions[i].base < regions[i].size)
+            return &regions[i];
+
+    return NULL;
+}
+
+static void protect(const struct region *r, int prot){
+    mprotect((void *)(uintptr_t)r->base, r->size, prot);
+}
+
+static void protect_all(int prot){
+
+    size_t i;
+
+    for(i = 0; i < NREGIONS; i++)
+        if(regions[i].traced)
+            protect(&regions[i], prot);
+}
+
+void rt_trap_open(void){
+    protect_all(PROT_READ | PROT_WRITE);
+}
+
+void rt_trap_close(void){
+    protect_all(PROT_NONE);
+}
+
+static void on_segv(int sig, siginfo_t *si, void *ctx){
+
+    ucontext_t *uc = ctx;
+    uintptr_t addr = (uintptr_t)si->si_addr;
+    const struct region *r = find_region(addr);
+
+    if(pending || r == NULL){
+        /* a real crash: let it happen */
+        signal(sig, SIG_DFL);
+        return;
+    }
+
+    /* the model only touches the peripheral being accessed */
+    protect(r, PROT_READ | PROT_WRITE);
+    pending_region = r;
+    pending_addr = (uint32_t)addr;
+    pending_write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+    pending_old = *(volatile uint32_t *)(addr & ~(uintptr_t)3);
+    if(!pending_write)
+        rt_model_read(pending_addr);
+    pending = 1;
+
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+static void on_trap(int sig, siginfo_t *si, void *ctx){
+
+    ucontext_t *uc = ctx;
+    uint32_t value;
+
+    (void)si;
+    if(!pending){
+        signal(sig, SIG_DFL);
+        return;
+    }
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+    pending = 0;
+
+    value = *(volatile uint32_t *)(uintptr_t)(pending_addr & ~3u);
+    if(pending_write)
+        rt_model_write(pending_addr, pending_old);
+    protect(pending_region, PROT_NONE);
+
+    /* may not return if the run has to stop */
+    rt_record(pending_addr, pending_write, value);
+}
+
+int rt_trap_init(void){
+
+    struct sigaction sa;
+    size_t i;
+
+    for(i = 0; i < NREGIONS; i++){
+        void *want = (void *)(uintptr_t)regions[i].base;
+        void *p = mmap(want, regions[i].size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+        if(p != want){
+            fprintf(stderr, "regtrace: cannot map 0x%08x-0x%08x\n",
+                    (unsigned)regions[i].base,
+                    (unsigned)(regions[i].base + regions[i].size - 1));
+            return -1;
+        }
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sa.sa_sigaction = on_segv;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = on_trap;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    rt_model_reset();
+    rt_trap_close();
+
+    return 0;
+}
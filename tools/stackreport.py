@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Worst-case stack depth from GCC -fstack-usage/-fcallgraph-info=su output.
+
+Reads the .ci call graphs of every compiled unit, walks the deepest call
+chain from main and from every interrupt/exception handler, writes a text
+report and a linker script fragment defining _stack_worst_case, which the
+linker script checks against the reserved stack.
+
+Worst case assumes any handler may preempt main and each other (no priority
+information is available here): main + sum(handler + exception frame).
+Calls that cannot be resolved statically (indirect calls, functions without
+call graph data such as libgcc helpers or assembly) count as zero and are
+listed as warnings. Calls through function pointers are added with --edge;
+since the budget check depends on them, an edge naming a function without
+call graph data is an error.
+"""
+
+import argparse
+import re
+import sys
+
+# 8 stacked words plus the optional alignment word
+EXCEPTION_FRAME = 36
+
+NODE_RE = re.compile(r'node:\s*\{\s*title:\s*"([^"]*)"\s*label:\s*"([^"]*)"')
+EDGE_RE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]*)"\s*targetname:\s*"([^"]*)"')
+SIZE_RE = re.compile(r'(\d+) bytes \(([^)]*)\)')
+HANDLER_RE = re.compile(r'_(IRQ)?Handler$')
+
+INDIRECT = '__indirect_call'
+
+
+class Function:
+    def __init__(self, title, name, where, size, qualifier):
+        self.title = title
+        self.name = name
+        self.where = where
+        self.size = size
+        self.qualifier = qualifier
+        self.calls = []
+
+
+def parse(paths):
+    funcs = {}
+    edges = []
+    for path in paths:
+        with open(path) as f:
+            text = f.read()
+        for title, label in NODE_RE.findall(text):
+            if title == INDIRECT:
+                continue
+            parts = label.split('\\n')
+            m = SIZE_RE.search(label)
+            if m is None:
+                # declaration only (external function referenced here)
+                continue
+            funcs[title] = Function(title, parts[0], parts[1] if len(parts) > 1 else '',
+                                    int(m.group(1)), m.group(2))
+        edges.extend(EDGE_RE.findall(text))
+    return funcs, edges
+
+
+def resolve(funcs, name):
+    """Titles matching name: a .ci title ("src/link.c:link_dispatch" for a
+    static function), a plain function name or file:name"""
+    if name in funcs:
+        return [name]
+    path, _, func = name.rpartition(':')
+    return sorted(t for t, f in funcs.items()
+                  if f.name == func and (not path or f.where.startswith(path + ':')))
+
+
+def parse_edge(funcs, edge):
+    """(caller, callee) titles of a --edge caller:callee, either side
+    possibly file-qualified, so try every ':' as the separator"""
+    parts = edge.split(':')
+    found = []
+    for i in range(1, len(parts)):
+        caller = resolve(funcs, ':'.join(parts[:i]))
+        callee = resolve(funcs, ':'.join(parts[i:]))
+        if caller and callee:
+            found.append((caller, callee))
+    if not found:
+        sys.exit('stackreport: --edge %s: no call graph data for the caller or the callee'
+                 % edge)
+    if len(found) > 1 or len(found[0][0]) > 1 or len(found[0][1]) > 1:
+        names = sorted(set(t for c in found for side in c
+                           if len(side) > 1 or len(found) > 1 for t in side))
+        sys.exit('stackreport: --edge %s is ambiguous, qualify it with the file: %s'
+                 % (edge, ', '.join(names)))
+    return found[0][0][0], found[0][1][0]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('ci', nargs='+', help='.ci files from -fcallgraph-info=su')
+    ap.add_argument('-o', '--output', required=True, help='linker script fragment to write')
+    ap.add_argument('-r', '--report', help='text report (default: stdout)')
+    ap.add_argument('--edge', action='append', default=[],
+                    help='extra caller:callee edge the compiler cannot see (asm branches, '
+                         'function pointers); names or file:name titles')
+    args = ap.parse_args()
+
+    funcs, edges = parse(args.ci)
+    for e in args.edge:
+        edges.append(parse_edge(funcs, e))
+
+    warnings = []
+    unknown = set()
+    for src, dst in edges:
+        if src not in funcs:
+            continue
+        if dst == INDIRECT:
+            warnings.append('%s: indirect call, not accounted' % funcs[src].name)
+            continue
+        funcs[src].calls.append(dst)
+        if dst not in funcs:
+            unknown.add(dst)
+
+    for f in funcs.values():
+        if 'dynamic' in f.qualifier and 'bounded' not in f.qualifier:
+            warnings.append('%s: unbounded dynamic stack (alloca/VLA)' % f.name)
+    for name in sorted(unknown):
+        warnings.append('%s: no stack usage data, counted as 0' % name)
+
+    memo = {}
+    active = set()
+
+    def worst(title):
+        """(bytes, chain) of the deepest path starting at title"""
+        if title in memo:
+            return memo[title]
+        f = funcs.get(title)
+        if f is None:
+            return 0, [title + '?']
+        if title in active:
+            warnings.append('%s: recursion, depth not bounded' % f.name)
+            return 0, [f.name + ' (recursion)']
+        active.add(title)
+        best, chain = 0, []
+        for callee in f.calls:
+            n, c = worst(callee)
+            if n > best or not chain:
+                best, chain = n, c
+        active.discard(title)
+        memo[title] = (f.size + best, [f.name] + chain)
+        return memo[title]
+
+    if 'main' not in funcs:
+        sys.exit('stackreport: main not found in call graph data')
+
+    handlers = sorted(t for t, f in funcs.items()
+                      if HANDLER_RE.search(f.name) and f.name != 'Reset_Handler')
+
+    rows = []
+    n, chain = worst('main')
+    rows.append(('main', n, chain))
+    total = n
+    for h in handlers:
+        n, chain = worst(h)
+        rows.append((funcs[h].name, n, chain))
+        total += n + EXCEPTION_FRAME
+
+    out = ['Worst-case stack usage (bytes)', '']
+    for name, n, chain in rows:
+        out.append('%-28s %6d  %s' % (name, n, ' > '.join(chain)))
+    out.append('')
+    out.append('%-28s %6d  (%d handlers x %d)' % ('exception frames', len(handlers) * EXCEPTION_FRAME,
+                                                   len(handlers), EXCEPTION_FRAME))
+    out.append('%-28s %6d' % ('worst case', total))
+    if warnings:
+        out.append('')
+        out.append('Warnings:')
+        out.extend('  ' + w for w in sorted(set(warnings)))
+    text = '\n'.join(out) + '\n'
+
+    if args.report:
+        with open(args.report, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+    with open(args.output, 'w') as f:
+        f.write('/* Generated by tools/stackreport.py, do not edit */\n')
+        f.write('_stack_worst_case = %d;\n' % total)
+
+
+if __name__ == '__main__':
+    main()
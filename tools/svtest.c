@@ -0,0 +1,162 @@
+/*
+ * Host test of the watchdog liveness logic (src/supervisor.c) on a
+ * simulated tick counter.
+ *
+ *   svtest
+ *
+ * Covers deadline expiry, the cached earliest expiry when tasks other than
+ * the earliest check in, 32-bit tick wrap-around and a random run checked
+ * against a brute force scan. Exits with 1 on the first failure.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "supervisor.h"
+
+static int failures;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(int ok, const char *what, int line){
+    if(!ok){
+        fprintf(stderr, "svtest:%d: %s\n", line, what);
+        failures++;
+    }
+}
+
+/* alive() and expired() have to agree, and both with the expected mask */
+static void expect(const struct supervisor *sv, uint32_t now, uint32_t mask, int line){
+
+    uint32_t got = supervisor_expired(sv, now);
+
+    if(got != mask || supervisor_alive(sv, now) != (mask == 0)){
+        fprintf(stderr, "svtest:%d: at %u expired 0x%x alive %d, expected 0x%x\n", line,
+                (unsigned)now, (unsigned)got, supervisor_alive(sv, now), (unsigned)mask);
+        failures++;
+    }
+}
+
+#define EXPECT(sv, now, mask) expect((sv), (now), (mask), __LINE__)
+
+static void test_expiry(uint32_t t0){
+
+    struct supervisor sv;
+    int a, b;
+
+    supervisor_init(&sv);
+    EXPECT(&sv, t0, 0);
+
+    a = supervisor_register(&sv, "a", 100, t0);
+    b = supervisor_register(&sv, "b", 300, t0);
+    CHECK(a == 0 && b == 1);
+
+    /* the deadline itself is still in time */
+    EXPECT(&sv, t0 + 100, 0);
+    EXPECT(&sv, t0 + 101, 1u << a);
+    EXPECT(&sv, t0 + 301, (1u << a) | (1u << b));
+
+    /* the earliest checks in: the next one becomes b */
+    supervisor_checkin(&sv, a, t0 + 90);
+    EXPECT(&sv, t0 + 190, 0);
+    EXPECT(&sv, t0 + 191, 1u << a);
+    supervisor_checkin(&sv, a, t0 + 250);
+    EXPECT(&sv, t0 + 300, 0);
+    EXPECT(&sv, t0 + 301, 1u << b);
+}
+
+static void test_not_earliest(uint32_t t0){
+
+    struct supervisor sv;
+    int a, b, c;
+
+    supervisor_init(&sv);
+    a = supervisor_register(&sv, "a", 100, t0);
+    b = supervisor_register(&sv, "b", 50, t0);
+    c = supervisor_register(&sv, "c", 500, t0);
+    CHECK(sv.earliest == (uint32_t)b);
+
+    /* a and c are not the earliest: b stays cached */
+    supervisor_checkin(&sv, a, t0 + 40);
+    supervisor_checkin(&sv, c, t0 + 45);
+    CHECK(sv.earliest == (uint32_t)b);
+    EXPECT(&sv, t0 + 50, 0);
+    EXPECT(&sv, t0 + 51, 1u << b);
+
+    /* b moves past a, which has to be found again */
+    supervisor_checkin(&sv, b, t0 + 100);
+    CHECK(sv.earliest == (uint32_t)a);
+    EXPECT(&sv, t0 + 140, 0);
+    EXPECT(&sv, t0 + 141, 1u << a);
+    EXPECT(&sv, t0 + 151, (1u << a) | (1u << b));
+
+    /* bad ids are ignored */
+    supervisor_checkin(&sv, -1, t0 + 141);
+    supervisor_checkin(&sv, 3, t0 + 141);
+    EXPECT(&sv, t0 + 141, 1u << a);
+}
+
+static void test_full(void){
+
+    struct supervisor sv;
+    int i;
+
+    supervisor_init(&sv);
+    for(i = 0; i < SUPERVISOR_MAX_TASKS; i++)
+        CHECK(supervisor_register(&sv, "t", 10, 0) == i);
+    CHECK(supervisor_register(&sv, "t", 10, 0) == -1);
+}
+
+/* Random check-ins, compared with a scan of the tasks */
+static void test_random(uint32_t t0, unsigned steps){
+
+    struct supervisor sv;
+    uint32_t last[SUPERVISOR_MAX_TASKS], deadline[SUPERVISOR_MAX_TASKS];
+    uint32_t now = t0, mask;
+    int i, n = 1 + rand() % SUPERVISOR_MAX_TASKS;
+
+    supervisor_init(&sv);
+    for(i = 0; i < n; i++){
+        deadline[i] = 1 + rand() % 1000;
+        last[i] = now;
+        supervisor_register(&sv, "t", deadline[i], now);
+    }
+    while(steps-- > 0){
+        now += rand() % 300;
+        if(rand() % 2){
+            i = rand() % n;
+            supervisor_checkin(&sv, i, now);
+            last[i] = now;
+        }
+        for(i = 0, mask = 0; i < n; i++)
+            if(now - last[i] > deadline[i])
+                mask |= 1u << i;
+        EXPECT(&sv, now, mask);
+        if(failures)
+            return;
+    }
+}
+
+int main(void){
+
+    /* plain, and with the deadlines across the 32-bit wrap */
+    static const uint32_t starts[] = { 0, 0xFFFFFF00u, 0xFFFFFFFFu, 0x7FFFFFC0u };
+    size_t i;
+
+    for(i = 0; i < sizeof(starts) / sizeof(starts[0]); i++){
+        test_expiry(starts[i]);
+        test_not_earliest(starts[i]);
+    }
+    test_full();
+
+    srand(1);
+    for(i = 0; i < 1000 && !failures; i++)
+        test_random(rand() % 2 ? 0xFFFF0000u + (uint32_t)rand() : (uint32_t)rand(), 200);
+
+    if(failures){
+        fprintf(stderr, "svtest: %d failures\n", failures);
+        return 1;
+    }
+    printf("svtest: ok\n");
+
+    return 0;
+}